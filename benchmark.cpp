@@ -0,0 +1,1537 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "lib/KdenliveProject.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+
+// COMPILE:
+//  g++ benchmark.cpp lib/*.cpp -O2 -o benchmark.exe
+//
+//  RUN:
+//  benchmark.exe [max_clip_count] [output_json_path]
+//  benchmark.exe --allocations [clip_count] [output_json_path]
+//
+//  Every workload is run at 1k, 10k, 100k and 1M clips, up to max_clip_count (1M by default).
+//  The results are written as JSON to output_json_path, or to stdout if no path is given,
+//  so that the results of two versions of the library can be diffed.
+//
+//  With --allocations, every workload is generated once at clip_count clips (10k by default), and the allocations
+//  made by each phase and by each low-level KdenliveFile call are reported instead.
+//  The program then exits with 1 if any of them are over their budget in ALLOCATION_BUDGETS, so it can be run in CI.
+//
+//  benchmark.exe --verify [random_seed_count]
+//
+//  With --verify, the output of every way of generating a project is checked instead, and the program exits with 1 on any difference:
+//  The seeded projects in GOLDEN_OUTPUTS must generate exactly the output recorded for them,
+//  and for random_seed_count (100 by default) more seeded projects, incremental generation, snapshots, manifests,
+//  and loading the saved .kdenlive file must all generate the same output as generating the project from scratch.
+//  Render zones and the render job files are checked as well, without running melt,
+//  along with edits to tracks, time queries, nested sequences, the layering of clips by priority, mixes, crossfades, volumes, ducking, and markers.
+
+const char* BENCHMARK_FOLDER = "benchmark_files";
+const int MEDIA_FOLDER_FILE_COUNT = 1000;
+const int FIND_FILE_PATH_LOOKUP_COUNT = 1000;
+const int ALLOCATION_CALL_COUNT = 1000;
+
+
+// ALLOCATION COUNTING
+// Every operator new in the program goes through here, so the allocations made by any call can be counted
+std::atomic<long long> allocation_count(0);
+std::atomic<long long> allocated_bytes(0);
+
+// The operators go through these, which are never inlined. Otherwise GCC inlines free() into the code that deletes
+// memory from operator new, and warns that they don't match (-Wmismatched-new-delete), although both are replaced here
+#ifdef _MSC_VER
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+BENCHMARK_NOINLINE void* allocateCounted(size_t size){
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    allocated_bytes.fetch_add(size, memory_order_relaxed);
+
+    void* ptr = malloc(size > 0 ? size : 1);
+    if(ptr == nullptr)
+        throw bad_alloc();
+    return ptr;
+}
+BENCHMARK_NOINLINE void freeCounted(void* ptr) noexcept{
+    free(ptr);
+}
+
+void* operator new(size_t size){
+    return allocateCounted(size);
+}
+void* operator new[](size_t size){
+    return allocateCounted(size);
+}
+void operator delete(void* ptr) noexcept{
+    freeCounted(ptr);
+}
+void operator delete[](void* ptr) noexcept{
+    freeCounted(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept{
+    freeCounted(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept{
+    freeCounted(ptr);
+}
+
+struct AllocationCount{
+    long long count;
+    long long bytes;
+};
+
+AllocationCount countAllocations(){
+    return { allocation_count.load(memory_order_relaxed), allocated_bytes.load(memory_order_relaxed) };
+}
+AllocationCount countAllocationsSince(const AllocationCount &start){
+    const AllocationCount now = countAllocations();
+    return { now.count - start.count, now.bytes - start.bytes };
+}
+
+// The most allocations a phase may make per clip, or a KdenliveFile call may make per call
+struct AllocationBudget{
+    string workload;
+    string phase;
+    double max_allocations_per_item;
+};
+const vector<AllocationBudget> ALLOCATION_BUDGETS = {
+    { "sequential", "CreateClip", 2 },
+    { "sequential", "GenerateFile", 10 },
+    { "heavy_overlap", "GenerateFile", 14 },
+    { "fade_everything", "GenerateFile", 85 },
+    { "unique_media", "GenerateFile", 36 },
+    { "reused_media", "GenerateFile", 10 },
+    { "sequential", "ToString", 0.01 },
+    { "KdenliveFile", "convertToTimestamp", 0.01 },
+    { "KdenliveFile", "AddTrack", 30 },
+    { "KdenliveFile", "AddClipToBin", 20 },
+    { "KdenliveFile", "AddBlankToTrack", 6 },
+    { "KdenliveFile", "AddClipToTrack", 11 },
+    { "KdenliveFile", "FadeClip", 70 },
+};
+
+
+// The size and FNV-1a hash of the output of the seeded random project with clip_count clips.
+// These were recorded from the output of the library, and must only be updated when its output is meant to change
+struct GoldenOutput{
+    uint32_t seed;
+    int clip_count;
+    size_t size;
+    uint64_t hash;
+};
+const vector<GoldenOutput> GOLDEN_OUTPUTS = {
+    { 1, 1, 9869, 0x8f47216378cbd845ULL },
+    { 2, 10, 16590, 0x97b1f09b2d4f131bULL },
+    { 3, 100, 67909, 0x25c78c489254bd26ULL },
+    { 4, 1000, 514759, 0xf4e7eca4af1b933dULL },
+    { 5, 10000, 4883875, 0x27c0e201a28fc1b3ULL },
+};
+
+
+// A synthetic project: where each clip is placed, and what it uses
+struct Workload{
+    string name;
+    function<void(KdenliveProject &proj, const int clip_count)> create_clips;
+};
+
+struct BenchmarkResult{
+    string workload;
+    string phase;
+    long long count;
+    double seconds;
+};
+
+
+double secondsSince(const chrono::steady_clock::time_point &start){
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+vector<Workload> createWorkloads(){
+    return {
+        // Clips one after the other, on a single track
+        { "sequential", [](KdenliveProject &proj, const int clip_count){
+            for(int i = 0; i < clip_count; i++)
+                proj.CreateClipOnVideoTrack(i * 2.0f, "media_" + to_string(i % 100), 2);
+        } },
+        // Every clip overlaps the 99 clips before it, needing 100 tracks
+        { "heavy_overlap", [](KdenliveProject &proj, const int clip_count){
+            for(int i = 0; i < clip_count; i++)
+                proj.CreateClipOnVideoTrack(i * 0.1f, "media_" + to_string(i % 100), 9.95f);
+        } },
+        // Sequential video and audio clips, every one of them faded
+        { "fade_everything", [](KdenliveProject &proj, const int clip_count){
+            for(int i = 0; i < clip_count; i += 2){
+                proj.CreateClipOnVideoTrack(i * 2.0f, "media_" + to_string(i % 100), 2)->SetFadeOffsets(0.5f, 0.5f);
+                proj.CreateClipOnAudioTrack(i * 2.0f, "media_" + to_string(i % 100), 2)->SetFadeOffsets(0.5f, 0.5f);
+            }
+        } },
+        // Sequential clips that all use different media
+        { "unique_media", [](KdenliveProject &proj, const int clip_count){
+            for(int i = 0; i < clip_count; i++)
+                proj.CreateClipOnVideoTrack(i * 2.0f, "unique_media_" + to_string(i), 2);
+        } },
+        // Sequential clips that all reuse the same few pieces of media
+        { "reused_media", [](KdenliveProject &proj, const int clip_count){
+            for(int i = 0; i < clip_count; i++)
+                proj.CreateClipOnVideoTrack(i * 2.0f, "media_" + to_string(i % 4), 2);
+        } },
+    };
+}
+
+// Times each phase of generating the workload separately
+void runWorkload(const Workload &workload, const int clip_count, vector<BenchmarkResult> &results){
+    KdenliveProject proj;
+
+    auto start = chrono::steady_clock::now();
+    workload.create_clips(proj, clip_count);
+    results.push_back( { workload.name, "CreateClip", clip_count, secondsSince(start) } );
+
+    // Media is not searched for here, so that path resolution is only measured by findFilePath
+    start = chrono::steady_clock::now();
+    KdenliveFile* file = proj.GenerateFile({});
+    results.push_back( { workload.name, "GenerateFile", clip_count, secondsSince(start) } );
+
+    start = chrono::steady_clock::now();
+    const string file_str = file->ToString();
+    results.push_back( { workload.name, "ToString", clip_count, secondsSince(start) } );
+
+    start = chrono::steady_clock::now();
+    file->SaveToFile(workload.name, BENCHMARK_FOLDER);
+    results.push_back( { workload.name, "SaveToFile", clip_count, secondsSince(start) } );
+
+    start = chrono::steady_clock::now();
+    delete file;
+    results.push_back( { workload.name, "DeleteFile", clip_count, secondsSince(start) } );
+
+    fs::remove( fs::path(BENCHMARK_FOLDER) / (workload.name + ".kdenlive") );
+}
+
+// Times looking up names in a media folder, half of which exist
+void runFindFilePath(vector<BenchmarkResult> &results){
+    const fs::path media_folder = fs::path(BENCHMARK_FOLDER) / "media";
+    fs::create_directories(media_folder);
+    for(int i = 0; i < MEDIA_FOLDER_FILE_COUNT; i++)
+        ofstream(media_folder / ("media_" + to_string(i) + ".mp4"));
+
+    const vector<string> media_folder_paths = { media_folder.string() };
+
+    const auto start = chrono::steady_clock::now();
+    for(int i = 0; i < FIND_FILE_PATH_LOOKUP_COUNT; i++)
+        findFilePath(media_folder_paths, "media_" + to_string(i * 2));
+    results.push_back( { "media_folder_" + to_string(MEDIA_FOLDER_FILE_COUNT) + "_files", "findFilePath", FIND_FILE_PATH_LOOKUP_COUNT, secondsSince(start) } );
+
+    fs::remove_all(media_folder);
+}
+
+// Times importing a manifest of sequential clips, with every tenth row also on an audio track
+void runImportManifest(const int row_count, vector<BenchmarkResult> &results){
+    const fs::path manifest_path = fs::path(BENCHMARK_FOLDER) / "manifest.csv";
+
+    FILE* manifest = fopen(manifest_path.string().c_str(), "wb");
+    fprintf(manifest, "time,name,length,offset,fade_in,fade_out,track\n");
+    for(int i = 0; i < row_count; i++)
+        fprintf(manifest, "%d.5,media_%d,4.25,0.5,0.5,0.5,%s\n", i * 4, i % 1000, (i % 10 == 0) ? "both" : "video");
+    fclose(manifest);
+
+    KdenliveProject proj;
+    const auto start = chrono::steady_clock::now();
+    const int imported_count = proj.ImportManifest(manifest_path.string());
+    results.push_back( { "manifest", "ImportManifest", imported_count, secondsSince(start) } );
+
+    fs::remove(manifest_path);
+}
+
+struct AllocationResult{
+    string workload;
+    string phase;
+    long long count;        // Clips, or calls for a KdenliveFile call
+    long long entries;      // Blanks and clips added to tracks
+    long long filters;
+    AllocationCount allocations;
+};
+
+// Counts the allocations of each phase of generating the workload
+void runWorkloadAllocations(const Workload &workload, const int clip_count, vector<AllocationResult> &results){
+    KdenliveProject proj;
+
+    AllocationCount start = countAllocations();
+    workload.create_clips(proj, clip_count);
+    results.push_back( { workload.name, "CreateClip", clip_count, 0, 0, countAllocationsSince(start) } );
+
+    // The stats are filled in by the generation, so they don't allocate during it
+    GenerationStats stats;
+    start = countAllocations();
+    KdenliveFile* file = proj.GenerateFile({}, &stats);
+    const AllocationCount generate_allocations = countAllocationsSince(start);
+    const long long entry_count = stats.clips_placed + stats.blanks_emitted;
+    results.push_back( { workload.name, "GenerateFile", clip_count, entry_count, stats.filters_emitted, generate_allocations } );
+
+    start = countAllocations();
+    const string file_str = file->ToString();
+    results.push_back( { workload.name, "ToString", clip_count, entry_count, stats.filters_emitted, countAllocationsSince(start) } );
+
+    delete file;
+}
+
+// Counts the allocations made by each call of the low-level KdenliveFile API
+void runKdenliveFileAllocations(vector<AllocationResult> &results){
+    KdenliveFile file;
+
+    // Every in, out, and length the file writes is formatted here, so it must not allocate for each call
+    AllocationCount start = countAllocations();
+    for(int i = 0; i < ALLOCATION_CALL_COUNT; i++)
+        convertToTimestamp(i * 1.5f);
+    results.push_back( { "KdenliveFile", "convertToTimestamp", ALLOCATION_CALL_COUNT, 0, 0, countAllocationsSince(start) } );
+
+    start = countAllocations();
+    for(int i = 0; i < ALLOCATION_CALL_COUNT; i++)
+        file.AddTrack(KdenliveFile::VIDEO);
+    results.push_back( { "KdenliveFile", "AddTrack", ALLOCATION_CALL_COUNT, 0, 0, countAllocationsSince(start) } );
+
+    start = countAllocations();
+    for(int i = 0; i < ALLOCATION_CALL_COUNT; i++)
+        file.AddClipToBin("media_folder/media.mp4");
+    results.push_back( { "KdenliveFile", "AddClipToBin", ALLOCATION_CALL_COUNT, 0, 0, countAllocationsSince(start) } );
+
+    start = countAllocations();
+    for(int i = 0; i < ALLOCATION_CALL_COUNT; i++)
+        file.AddBlankToTrack(i, 1.5f);
+    results.push_back( { "KdenliveFile", "AddBlankToTrack", ALLOCATION_CALL_COUNT, ALLOCATION_CALL_COUNT, 0, countAllocationsSince(start) } );
+
+    vector<TrackEntryId> entry_ids;
+    entry_ids.reserve(ALLOCATION_CALL_COUNT);
+    start = countAllocations();
+    for(int i = 0; i < ALLOCATION_CALL_COUNT; i++)
+        entry_ids.push_back( file.AddClipToTrack(i, i, 2.5f, 0.5f) );
+    results.push_back( { "KdenliveFile", "AddClipToTrack", ALLOCATION_CALL_COUNT, ALLOCATION_CALL_COUNT, 0, countAllocationsSince(start) } );
+
+    start = countAllocations();
+    for(int i = 0; i < ALLOCATION_CALL_COUNT; i++)
+        file.FadeClip(i, entry_ids[i], 0.5f, 0.5f);
+    results.push_back( { "KdenliveFile", "FadeClip", ALLOCATION_CALL_COUNT, 0, 2 * ALLOCATION_CALL_COUNT, countAllocationsSince(start) } );
+}
+
+// Prints every result over its budget, and returns true if all of them are within it
+bool checkAllocationBudgets(const vector<AllocationResult> &results){
+    bool is_within_budget = true;
+
+    for(const AllocationBudget &budget : ALLOCATION_BUDGETS){
+        for(const AllocationResult &result : results){
+            if(result.workload != budget.workload  ||  result.phase != budget.phase)
+                continue;
+
+            const double allocations_per_item = static_cast<double>(result.allocations.count) / result.count;
+            if(allocations_per_item > budget.max_allocations_per_item){
+                cerr << "OVER BUDGET: " << result.workload << " " << result.phase << " made " << allocations_per_item
+                     << " allocations per item, budget is " << budget.max_allocations_per_item << "\n";
+                is_within_budget = false;
+            }
+        }
+    }
+
+    return is_within_budget;
+}
+
+string convertAllocationResultsToJson(const vector<AllocationResult> &results){
+    stringstream json;
+    json << "{\n  \"allocations\": [\n";
+
+    for(size_t i = 0; i < results.size(); i++){
+        const AllocationResult &result = results[i];
+        json << "    { \"workload\": \"" << result.workload << "\""
+             << ", \"phase\": \"" << result.phase << "\""
+             << ", \"count\": " << result.count
+             << ", \"allocations\": " << result.allocations.count
+             << ", \"bytes\": " << result.allocations.bytes
+             << ", \"allocations_per_item\": " << static_cast<double>(result.allocations.count) / result.count
+             << ", \"bytes_per_item\": " << static_cast<double>(result.allocations.bytes) / result.count;
+        if(result.entries > 0)
+            json << ", \"allocations_per_entry\": " << static_cast<double>(result.allocations.count) / result.entries;
+        if(result.filters > 0)
+            json << ", \"allocations_per_filter\": " << static_cast<double>(result.allocations.count) / result.filters;
+        json << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+string convertResultsToJson(const vector<BenchmarkResult> &results){
+    stringstream json;
+    json << "{\n  \"results\": [\n";
+
+    for(size_t i = 0; i < results.size(); i++){
+        const BenchmarkResult &result = results[i];
+        json << "    { \"workload\": \"" << result.workload << "\""
+             << ", \"phase\": \"" << result.phase << "\""
+             << ", \"count\": " << result.count
+             << ", \"seconds\": " << result.seconds
+             << ", \"ns_per_item\": " << (result.count > 0 ? result.seconds * 1e9 / result.count : 0)
+             << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+
+// A clip of a random project, as it would be written in a manifest
+struct RandomClip{
+    float time_stamp;
+    string name;
+    float length;
+    float start_offset;
+    float fade_in_time;
+    float fade_out_time;
+    string track_type;
+};
+
+// Creates a project of clips at random times on random tracks, that is the same on every platform for the same seed
+vector<RandomClip> createRandomClips(const uint32_t seed, const int clip_count){
+    // The distributions of the standard library differ between implementations, so only the raw engine output is used
+    mt19937 rng(seed);
+    const char* track_types[] = { "video", "audio", "both" };
+
+    vector<RandomClip> clips;
+    for(int i = 0; i < clip_count; i++){
+        RandomClip clip;
+        clip.time_stamp = (rng() % 4000) / 10.0f;
+        clip.name = "media_" + to_string(rng() % 30);
+        clip.length = 1 + (rng() % 100) / 10.0f;
+        clip.start_offset = (rng() % 20) / 10.0f;
+        const bool is_faded = rng() % 3 == 0;
+        clip.fade_in_time = is_faded ? (rng() % 10) / 10.0f : 0;
+        clip.fade_out_time = is_faded ? (rng() % 10) / 10.0f : 0;
+        clip.track_type = track_types[rng() % 3];
+        clips.push_back(clip);
+    }
+
+    return clips;
+}
+
+// Returns the Clip* created for each clip
+vector<Clip*> addRandomClips(KdenliveProject &proj, const vector<RandomClip> &clips){
+    vector<Clip*> created_clips;
+    for(const RandomClip &random_clip : clips){
+        Clip* clip = proj.CreateClip(random_clip.name, random_clip.length, random_clip.start_offset);
+        clip->SetFadeOffsets(random_clip.fade_in_time, random_clip.fade_out_time);
+
+        if(random_clip.track_type != "audio")
+            proj.AddClipToVideoTrack(random_clip.time_stamp, clip);
+        if(random_clip.track_type != "video")
+            proj.AddClipToAudioTrack(random_clip.time_stamp, clip);
+        created_clips.push_back(clip);
+    }
+
+    return created_clips;
+}
+
+void saveRandomClipsAsManifest(const vector<RandomClip> &clips, const string &manifest_path){
+    FILE* manifest = fopen(manifest_path.c_str(), "wb");
+    fprintf(manifest, "time,name,length,offset,fade_in,fade_out,track\n");
+    // 9 significant digits are enough for every float to be parsed back to exactly the same value
+    for(const RandomClip &clip : clips)
+        fprintf(manifest, "%.9g,%s,%.9g,%.9g,%.9g,%.9g,%s\n", clip.time_stamp, clip.name.c_str(), clip.length,
+                clip.start_offset, clip.fade_in_time, clip.fade_out_time, clip.track_type.c_str());
+    fclose(manifest);
+}
+
+uint64_t hashOutput(const string &output){
+    uint64_t hash = 14695981039346656037ULL;
+    for(const char c : output){
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+string generateOutput(const vector<RandomClip> &clips, const bool is_filling_gaps = false){
+    KdenliveProject proj;
+    proj.SetFillGaps(is_filling_gaps);
+    addRandomClips(proj, clips);
+    return proj.SaveAsString({});
+}
+
+// Prints the first difference between the two outputs, and returns true if there is none
+bool checkSameOutput(const string &check_name, const uint32_t seed, const string &expected, const string &actual){
+    if(expected == actual)
+        return true;
+
+    size_t difference_index = 0;
+    while(difference_index < expected.size()  &&  difference_index < actual.size()  &&  expected[difference_index] == actual[difference_index])
+        difference_index++;
+
+    const size_t context_start = (difference_index > 40) ? difference_index - 40 : 0;
+    cerr << "MISMATCH: " << check_name << " with seed " << seed << " differs at byte " << difference_index << "\n"
+         << "  expected: " << expected.substr(context_start, 120) << "\n"
+         << "  actual:   " << actual.substr(context_start, 120) << "\n";
+    return false;
+}
+
+string readFile(const fs::path &file_path){
+    stringstream contents;
+    contents << ifstream(file_path, ios::binary).rdbuf();
+    return contents.str();
+}
+
+// Checks that the zones cover the timeline in order, start on whole frames, and don't cut through any clip max_uncut_clip_length or shorter
+bool checkRenderZones(const string &check_name, const uint32_t seed, const vector<RenderZone> &zones, const vector<RandomClip> &clips,
+                      const int zone_count, const float max_uncut_clip_length){
+    float timeline_end = 0;
+    for(const RandomClip &clip : clips)
+        timeline_end = max(timeline_end, clip.time_stamp + clip.length);
+    if(zones.empty()  ||  static_cast<int>(zones.size()) > zone_count  ||  zones.front().start_time != 0  ||  zones.back().end_time != timeline_end){
+        cerr << "MISMATCH: " << check_name << " with seed " << seed << " doesn't cover the timeline with at most " << zone_count << " zones\n";
+        return false;
+    }
+
+    for(size_t i = 1; i < zones.size(); i++){
+        const float boundary = zones[i].start_time;
+        const float boundary_frame = boundary * 30;
+        if(boundary != zones[i - 1].end_time  ||  boundary <= zones[i - 1].start_time  ||  fabsf(boundary_frame - roundf(boundary_frame)) > 1e-3f){
+            cerr << "MISMATCH: " << check_name << " with seed " << seed << " has a boundary at " << boundary << " that isn't on a frame after the last zone\n";
+            return false;
+        }
+        for(const RandomClip &clip : clips){
+            if(clip.length <= max_uncut_clip_length  &&  clip.time_stamp + 1e-3f < boundary  &&  boundary < clip.time_stamp + clip.length - 1e-3f){
+                cerr << "MISMATCH: " << check_name << " with seed " << seed << " cuts the clip at " << clip.time_stamp << " at " << boundary << "\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Finds the clips of one timeline that play for any part of the range by scanning every clip, in order of time.
+// An empty range finds the clips playing at start_time
+vector<TimelineClip> scanClipsInRange(const vector<RandomClip> &clips, const vector<Clip*> &created_clips, const string &excluded_track_type,
+                                      const float start_time, const float end_time){
+    vector<TimelineClip> found_clips;
+    for(size_t i = 0; i < clips.size(); i++){
+        const RandomClip &clip = clips[i];
+        const bool is_started = (end_time > start_time) ? clip.time_stamp < end_time : clip.time_stamp <= start_time;
+        if(clip.track_type != excluded_track_type  &&  is_started  &&  clip.time_stamp + clip.length > start_time)
+            found_clips.push_back( {clip.time_stamp, created_clips[i]} );
+    }
+    // Clips placed at the same time stay in the order they were added
+    stable_sort(found_clips.begin(), found_clips.end(), [](const TimelineClip &a, const TimelineClip &b){
+        return a.time_stamp < b.time_stamp;
+    });
+
+    return found_clips;
+}
+
+// Checks FindClipsAt() and FindClipsInRange() against scanning every clip, at the start, middle, and end of some of the clips
+bool checkTimeQueries(const string &check_name, const uint32_t seed, const KdenliveProject &proj, const vector<RandomClip> &clips,
+                      const vector<Clip*> &created_clips){
+    auto isSame = [](const vector<TimelineClip> &a, const vector<TimelineClip> &b){
+        return equal(a.begin(), a.end(), b.begin(), b.end(), [](const TimelineClip &x, const TimelineClip &y){
+            return x.time_stamp == y.time_stamp  &&  x.clip == y.clip;
+        });
+    };
+
+    const pair<KdenliveFile::TrackType, string> timelines[] = { {KdenliveFile::VIDEO, "audio"}, {KdenliveFile::AUDIO, "video"} };
+    for(const auto &timeline : timelines){
+        for(size_t i = 0; i < clips.size()  &&  i < 20; i++){
+            const float start_time = clips[i].time_stamp;
+            const float end_time = clips[i].time_stamp + clips[i].length;
+            for(const float time_stamp : { start_time, (start_time + end_time) / 2, end_time }){
+                if(!isSame(proj.FindClipsAt(timeline.first, time_stamp), scanClipsInRange(clips, created_clips, timeline.second, time_stamp, time_stamp))){
+                    cerr << "MISMATCH: " << check_name << " with seed " << seed << " finds different clips at " << time_stamp << "\n";
+                    return false;
+                }
+            }
+            // The range of the clip, the empty range at its end, and a reversed range, which are both the same as its end
+            const pair<float, float> ranges[] = { {start_time, end_time}, {end_time, end_time}, {end_time, start_time}, {start_time - 1, start_time} };
+            for(const auto &range : ranges){
+                if(!isSame(proj.FindClipsInRange(timeline.first, range.first, range.second),
+                           scanClipsInRange(clips, created_clips, timeline.second, range.first, range.second))){
+                    cerr << "MISMATCH: " << check_name << " with seed " << seed << " finds different clips from " << range.first << " to " << range.second << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Copies the clips placed on the video timeline, named by their index so each can be found in the output
+vector<RandomClip> selectVideoClips(const vector<RandomClip> &clips){
+    vector<RandomClip> video_clips;
+    for(const RandomClip &clip : clips){
+        if(clip.track_type == "audio")
+            continue;
+        video_clips.push_back(clip);
+        video_clips.back().name = "media_" + to_string(video_clips.size() - 1);
+        video_clips.back().track_type = "video";
+    }
+
+    return video_clips;
+}
+
+// Reads the video track of each clip named "media_<clip index>" from the output, or -1 for clips on no video track,
+// and counts the clips in the second playlists of the tracks. Returns the number of video tracks
+int readVideoTracks(const string &output, vector<int> &clip_tracks, int &mix_clip_count){
+    tinyxml2::XMLDocument doc;
+    doc.Parse(output.c_str());
+    const tinyxml2::XMLElement* mlt = doc.FirstChildElement("mlt");
+
+    map<string, int> chain_clips;
+    map<string, const tinyxml2::XMLElement*> playlists;
+    int video_track_count = 0;
+    for(const tinyxml2::XMLElement* element = mlt->FirstChildElement(); element != nullptr; element = element->NextSiblingElement()){
+        const string element_name = element->Name();
+        if(element_name == "chain"){
+            // The resource is the name of the clip with an extension, which stoi() stops at
+            const tinyxml2::XMLElement* property = element->FirstChildElement("property");
+            for(; property != nullptr  &&  string(property->Attribute("name")) != "resource"; property = property->NextSiblingElement("property"));
+            if(property != nullptr)
+                chain_clips[element->Attribute("id")] = stoi( string(property->GetText()).substr(6) );
+        }
+        else if(element_name == "playlist")
+            playlists[element->Attribute("id")] = element;
+        else if(element_name == "tractor"){
+            // Video tracks hide the audio of both their playlists
+            const tinyxml2::XMLElement* track = element->FirstChildElement("track");
+            if(track == nullptr  ||  track->Attribute("hide", "audio") == nullptr)
+                continue;
+            for(bool is_mix_playlist = false; track != nullptr; track = track->NextSiblingElement("track"), is_mix_playlist = true){
+                for(const tinyxml2::XMLElement* entry = playlists[track->Attribute("producer")]->FirstChildElement("entry"); entry != nullptr;
+                    entry = entry->NextSiblingElement("entry")){
+                    clip_tracks[ chain_clips[entry->Attribute("producer")] ] = video_track_count;
+                    mix_clip_count += is_mix_playlist ? 1 : 0;
+                }
+            }
+            video_track_count++;
+        }
+    }
+
+    return video_track_count;
+}
+
+// Checks that every clip is above every clip of a lower priority that it overlaps, and that the tracks are the ones
+// found by placing each clip, from the lowest priority up, on the lowest track that is above them and free of its own priority
+bool checkPriorityLayout(const string &check_name, const uint32_t seed, const vector<RandomClip> &clips, const vector<int> &priorities, const string &output){
+    vector<int> clip_tracks(clips.size(), -1);
+    int mix_clip_count = 0;
+    const int video_track_count = readVideoTracks(output, clip_tracks, mix_clip_count);
+
+    auto isOverlapping = [&clips](const size_t a, const size_t b){
+        return clips[a].time_stamp < clips[b].time_stamp + clips[b].length  &&  clips[b].time_stamp < clips[a].time_stamp + clips[a].length;
+    };
+    for(size_t a = 0; a < clips.size(); a++){
+        for(size_t b = 0; b < clips.size(); b++){
+            if(priorities[a] > priorities[b]  &&  isOverlapping(a, b)  &&  clip_tracks[a] <= clip_tracks[b]){
+                cerr << "MISMATCH: " << check_name << " with seed " << seed << " puts the clip at " << clips[a].time_stamp
+                     << " on track " << clip_tracks[a] << ", not above the lower priority clip on track " << clip_tracks[b] << "\n";
+                return false;
+            }
+        }
+    }
+
+    // Clips placed at the same time are on the timeline in the order they were added
+    vector<size_t> clip_order(clips.size());
+    for(size_t i = 0; i < clip_order.size(); i++)
+        clip_order[i] = i;
+    stable_sort(clip_order.begin(), clip_order.end(), [&](const size_t a, const size_t b){
+        return (priorities[a] != priorities[b]) ? priorities[a] < priorities[b] : clips[a].time_stamp < clips[b].time_stamp;
+    });
+    vector<int> expected_tracks(clips.size(), -1);
+    int expected_track_count = 0;
+    for(size_t order_index = 0; order_index < clip_order.size(); order_index++){
+        const size_t i = clip_order[order_index];
+        int track = 0;
+        for(size_t j = 0; j < clips.size(); j++){
+            if(expected_tracks[j] >= 0  &&  priorities[j] < priorities[i]  &&  isOverlapping(i, j))
+                track = max(track, expected_tracks[j] + 1);
+        }
+        for(bool is_track_free = false; !is_track_free; track += is_track_free ? 0 : 1){
+            is_track_free = true;
+            for(size_t j = 0; j < clips.size(); j++)
+                is_track_free = is_track_free  &&  !(expected_tracks[j] == track  &&  priorities[j] == priorities[i]  &&  isOverlapping(i, j));
+        }
+        expected_tracks[i] = track;
+        expected_track_count = max(expected_track_count, track + 1);
+    }
+    if(clip_tracks != expected_tracks  ||  video_track_count != expected_track_count){
+        cerr << "MISMATCH: " << check_name << " with seed " << seed << " uses " << video_track_count << " video tracks, where "
+             << expected_track_count << " are needed, or places a clip on a different track\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Checks generating the project incrementally, after adding half of the clips and then the rest, against generating it from scratch.
+// set_up is called after each batch of clips is added, with the clips just added and the index of the first of them
+bool checkIncrementalOutput(const string &check_name, const uint32_t seed, const vector<RandomClip> &clips,
+                            const function<void(KdenliveProject&, const vector<Clip*>&, size_t)> &set_up){
+    KdenliveProject expected_proj;
+    set_up(expected_proj, addRandomClips(expected_proj, clips), 0);
+    const string expected = expected_proj.SaveAsString({});
+
+    KdenliveProject proj;
+    proj.SetIncrementalGeneration(true);
+    const size_t half_clip_count = clips.size() / 2;
+    set_up(proj, addRandomClips(proj, vector<RandomClip>(clips.begin(), clips.begin() + half_clip_count)), 0);
+    proj.SaveAsString({});
+    set_up(proj, addRandomClips(proj, vector<RandomClip>(clips.begin() + half_clip_count, clips.end())), half_clip_count);
+
+    return checkSameOutput(check_name, seed, expected, proj.SaveAsString({}))
+           &&  checkSameOutput(check_name + " (unchanged)", seed, expected, proj.SaveAsString({}));
+}
+
+// Gives the clips volumes and volume keyframes, which are the same for the same clips however they are added.
+// first_index is the index of the first of the clips among all of the clips of the project
+void setRandomVolumes(const vector<Clip*> &created_clips, const size_t first_index){
+    for(size_t i = 0; i < created_clips.size(); i++){
+        switch((first_index + i) % 5){
+            case 0:     created_clips[i]->SetVolume(-6);                                    break;
+            case 1:     created_clips[i]->SetVolumeKeyframes({ {0, -3}, {1, -9} });         break;
+        }
+    }
+}
+
+// Gives the clips volumes, volume keyframes, audio roles, and markers, and adds guides, the same way as setRandomVolumes()
+void setRandomAudio(KdenliveProject &proj, const vector<Clip*> &created_clips, const size_t first_index){
+    setRandomVolumes(created_clips, first_index);
+    for(size_t i = 0; i < created_clips.size(); i++){
+        const size_t clip_index = first_index + i;
+        switch(clip_index % 5){
+            case 2:     created_clips[i]->SetAudioRole(Clip::DIALOG);                       break;
+            case 3:     created_clips[i]->SetAudioRole(Clip::MUSIC);                        break;
+        }
+        if(clip_index % 4 == 0){
+            created_clips[i]->AddMarkers({ {0.5f, "marker \"" + to_string(clip_index) + "\"", static_cast<int>(clip_index % 3)} });
+            proj.AddGuides({ {static_cast<float>(clip_index), "guide " + to_string(clip_index), 1} });
+        }
+    }
+}
+
+// Checks that clips which overlap briefly share a track, with a mix transition over each overlap
+bool checkMixedLayout(const uint32_t seed, const vector<RandomClip> &clips){
+    const vector<RandomClip> video_clips = selectVideoClips(clips);
+    vector<int> clip_tracks(video_clips.size(), -1);
+    int mix_clip_count = 0;
+    KdenliveProject default_proj;
+    addRandomClips(default_proj, video_clips);
+    const int default_track_count = readVideoTracks(default_proj.SaveAsString({}), clip_tracks, mix_clip_count);
+
+    MixSettings mix_settings;
+    mix_settings.max_overlap_length = 1;
+    KdenliveProject proj;
+    proj.SetMixSettings(mix_settings);
+    addRandomClips(proj, video_clips);
+    const string output = proj.SaveAsString({});
+    fill(clip_tracks.begin(), clip_tracks.end(), -1);
+    mix_clip_count = 0;
+    const int track_count = readVideoTracks(output, clip_tracks, mix_clip_count);
+
+    int mix_transition_count = 0;
+    for(size_t i = output.find("kdenlive:mixcut"); i != string::npos; i = output.find("kdenlive:mixcut", i + 1))
+        mix_transition_count++;
+    // Each mixed clip is mixed with the clip it starts over, and may also be mixed with the next clip of the first playlist
+    if(track_count > default_track_count  ||  find(clip_tracks.begin(), clip_tracks.end(), -1) != clip_tracks.end()
+       ||  mix_transition_count < mix_clip_count  ||  mix_transition_count > 2 * mix_clip_count){
+        cerr << "MISMATCH: mixes with seed " << seed << " use " << track_count << " video tracks rather than at most " << default_track_count
+             << ", leave out a clip, or add " << mix_transition_count << " mix transitions for " << mix_clip_count << " mixed clips\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Checks the mix transitions and the second playlist of a track, on a file built directly
+bool verifyMixes(){
+    bool is_same = true;
+
+    // The cut is in frames of the profile, which is 30000/1001 in the template until another profile is set
+    {
+        KdenliveFile file;
+        file.AddTrack(KdenliveFile::VIDEO);
+        file.AddMixTransition(0, 1, 1, false);
+        file.SetProfile(25, 1920, 1080);
+        file.AddMixTransition(0, 3, 1, false);
+        const string output = file.ToString();
+        if(output.find("<property name=\"kdenlive:mixcut\">14</property>") == string::npos
+           ||  output.find("<property name=\"kdenlive:mixcut\">12</property>") == string::npos){
+            cerr << "MISMATCH: mixes of 1 second should be cut after 14 frames at 29.97 fps, and after 12 frames at 25 fps\n";
+            is_same = false;
+        }
+    }
+
+    // A track with a mix can't be rippled, since the mix would stay where it is
+    {
+        KdenliveFile file;
+        file.AddTrack(KdenliveFile::VIDEO);
+        file.AddClipToBin("media_folder/media_0.mp4");
+        file.AddClipToTrack(0, 0, 2);
+        file.AddClipToTrack(0, 0, 2);
+        file.AddClipToMixPlaylist(0, 0, 1.5f, 1);
+        file.AddMixTransition(0, 1.5f, 0.5f, false);
+        const string output = file.ToString();
+
+        // The errors are expected, so they aren't printed
+        streambuf* cerr_buffer = cerr.rdbuf(nullptr);
+        const TrackEntryId entry_id = file.RippleInsertClip(0, 1, 0, 1);
+        file.RemoveEntry(0, 0);
+        cerr.rdbuf(cerr_buffer);
+        is_same &= checkSameOutput("ripple edits of a mixed track", 0, output, file.ToString());
+        if(entry_id != -1){
+            cerr << "MISMATCH: ripple inserts into a mixed track should be refused\n";
+            is_same = false;
+        }
+    }
+
+    return is_same;
+}
+
+// Counts the mix and crossfade transitions in the output, which are the only ones placed over a range of time
+int countTimedTransitions(const string &output){
+    const string transition_start = "<transition id=\"";
+    int transition_count = 0;
+    for(size_t i = output.find(transition_start); i != string::npos; i = output.find(transition_start, i + 1)){
+        // Their in and out attributes come right after the id
+        const size_t id_end = output.find('"', i + transition_start.size());
+        transition_count += output.compare(id_end + 1, 5, " in=\"") == 0;
+    }
+
+    return transition_count;
+}
+
+// Checks the crossfades between two clips that overlap on each timeline, and that every crossfade is counted in the stats
+bool verifyCrossfades(){
+    KdenliveProject proj;
+    proj.SetCrossfades(true);
+    proj.CreateClipOnVideoTrack(0, "media_0", 2);
+    proj.CreateClipOnVideoTrack(1, "media_1", 2);
+    proj.CreateClipOnAudioTrack(0, "media_0", 2);
+    proj.CreateClipOnAudioTrack(1, "media_1", 2);
+    GenerationStats stats;
+    const string output = proj.SaveAsString({}, &stats);
+
+    // A dissolve from the first video track to the second, and a crossfade between the audio tracks, over the overlap.
+    // Out points are inclusive, so they end on the last frame before 2 seconds of the 30 fps profile
+    const string overlap = "in=\"00:00:01.000\" out=\"00:00:01.966\">";
+    const size_t video_crossfade = output.find(overlap);
+    const size_t audio_crossfade = output.find(overlap, video_crossfade + 1);
+    if(countTimedTransitions(output) != 2  ||  stats.transitions_emitted != 2  ||  audio_crossfade == string::npos
+       ||  output.find("<property name=\"mlt_service\">luma</property>", video_crossfade) > audio_crossfade
+       ||  output.find("<property name=\"mlt_service\">mix</property>", audio_crossfade) == string::npos){
+        cerr << "MISMATCH: overlapping clips should have a dissolve on the video tracks and a crossfade on the audio tracks, from 1 to 2 seconds\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Checks render zones against known boundaries, and the job files saved for them, without running melt
+bool verifyRenderJobs(){
+    bool is_same = true;
+
+    // The middle of the cost is inside the short first clip, so the boundary moves to the closer end of it
+    {
+        const vector<RandomClip> clips = { { 0, "media_0", 4, 0, 0, 0, "video" }, { 4, "media_1", 1, 0, 0, 0, "video" } };
+        KdenliveProject proj;
+        addRandomClips(proj, clips);
+        const vector<RenderZone> zones = proj.ComputeRenderZones(2);
+        is_same &= checkRenderZones("render zones (short clip)", 0, zones, clips, 2, 5);
+        if(zones.size() != 2  ||  zones[0].end_time != 4){
+            cerr << "MISMATCH: render zones (short clip) should be cut at the end of the first clip\n";
+            is_same = false;
+        }
+
+        // Each job renders its zone in frames, with the last frame of one zone just before the first of the next
+        const fs::path job_folder = fs::path(BENCHMARK_FOLDER) / "render_jobs";
+        fs::create_directories(job_folder);
+        const int job_count = proj.SaveRenderJobs({}, 2, "jobs", job_folder.string(), "mkv");
+        const string first_job = readFile(job_folder / "jobs_zone0.mlt");
+        const string second_job = readFile(job_folder / "jobs_zone1.mlt");
+        const string script = readFile(job_folder / "jobs_render.sh");
+        if(job_count != 2
+           ||  first_job.find("<tractor id=\"final_tractor\" in=\"0\" out=\"119\"") == string::npos
+           ||  first_job.find("target=\"jobs_zone0.mkv\"") == string::npos
+           ||  second_job.find("<tractor id=\"final_tractor\" in=\"120\" out=\"149\"") == string::npos
+           ||  second_job.find("target=\"jobs_zone1.mkv\"") == string::npos
+           ||  readFile(job_folder / "jobs_zones.txt") != "file 'jobs_zone0.mkv'\nfile 'jobs_zone1.mkv'\n"
+           ||  script.find("melt -quiet \"jobs_zone0.mlt\" &") == string::npos
+           ||  script.find("melt -quiet \"jobs_zone1.mlt\" &") == string::npos
+           ||  script.find("-i \"jobs_zones.txt\" -c copy \"jobs.mkv\"") == string::npos){
+            cerr << "MISMATCH: render jobs don't render the zones 0-119 and 120-149 and join them\n";
+            is_same = false;
+        }
+        fs::remove_all(job_folder);
+    }
+
+    // A clip too long to keep whole is cut, with every boundary rounded to a frame
+    {
+        const vector<RandomClip> clips = { { 0, "media_0", 10.01f, 0, 0, 0, "video" } };
+        KdenliveProject proj;
+        addRandomClips(proj, clips);
+        const vector<RenderZone> zones = proj.ComputeRenderZones(3);
+        is_same &= checkRenderZones("render zones (long clip)", 0, zones, clips, 3, 5);
+        if(zones.size() != 3){
+            cerr << "MISMATCH: render zones (long clip) should cut the clip into 3 zones\n";
+            is_same = false;
+        }
+    }
+
+    return is_same;
+}
+
+// An entry of the test track, where a clip_id of -1 is a blank
+struct TrackTestEntry{
+    ClipId clip_id;
+    float length;
+};
+
+// Adds the track the edits are checked on, and the clips placed on it to the bin
+void addTestTrack(KdenliveFile &file){
+    file.AddTrack(KdenliveFile::VIDEO);
+    for(int i = 0; i < 4; i++)
+        file.AddClipToBin("media_folder/media_" + to_string(i) + ".mp4");
+}
+
+// Checks the edited track against a track built from scratch with the same entries, and the time of every entry on it
+bool checkTrackEntries(const string &check_name, const KdenliveFile &file, const vector<TrackTestEntry> &entries){
+    KdenliveFile expected_file;
+    addTestTrack(expected_file);
+    for(const TrackTestEntry &entry : entries){
+        if(entry.clip_id < 0)
+            expected_file.AddBlankToTrack(0, entry.length);
+        else
+            expected_file.AddClipToTrack(0, entry.clip_id, entry.length);
+    }
+    if(!checkSameOutput(check_name, 0, expected_file.ToString(), file.ToString()))
+        return false;
+
+    float time_stamp = 0;
+    for(size_t i = 0; i < entries.size(); i++){
+        const TrackEntryId entry_id = static_cast<TrackEntryId>(i);
+        if(file.GetEntryTime(0, entry_id) != time_stamp  ||  file.FindEntryAt(0, time_stamp + entries[i].length / 2) != entry_id){
+            cerr << "MISMATCH: " << check_name << " doesn't find entry " << i << " at " << time_stamp << "\n";
+            return false;
+        }
+        time_stamp += entries[i].length;
+    }
+    if(file.FindEntryAt(0, time_stamp + 1) != -1){
+        cerr << "MISMATCH: " << check_name << " finds an entry past the end of the track\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Checks rippled inserts and removals, and clips inserted into blanks, against building each track from scratch
+bool verifyTrackEdits(){
+    bool is_same = true;
+
+    // Rippled edits at the start, middle, and end of the track. The lengths are exact in binary, so the times add up exactly
+    {
+        KdenliveFile file;
+        addTestTrack(file);
+        vector<TrackTestEntry> entries = { {0, 2}, {-1, 2}, {1, 1}, {2, 1.5f} };
+        for(const TrackTestEntry &entry : entries){
+            if(entry.clip_id < 0)
+                file.AddBlankToTrack(0, entry.length);
+            else
+                file.AddClipToTrack(0, entry.clip_id, entry.length);
+        }
+
+        const int entry_count = static_cast<int>(entries.size());
+        for(const int entry_id : { 0, entry_count / 2 + 1, entry_count + 2 }){
+            file.RippleInsertClip(0, entry_id, 3, 0.5f);
+            entries.insert(entries.begin() + entry_id, {3, 0.5f});
+            is_same &= checkTrackEntries("ripple insert at entry " + to_string(entry_id), file, entries);
+        }
+        for(const int position : { 0, 1, 2 }){
+            // The start, middle, and end of what is left of the track
+            const int entry_id = position * (static_cast<int>(entries.size()) - 1) / 2;
+            file.RemoveEntry(0, entry_id);
+            entries.erase(entries.begin() + entry_id);
+            is_same &= checkTrackEntries("ripple remove of entry " + to_string(entry_id), file, entries);
+        }
+
+        // Without rippling, the entry leaves a blank behind
+        file.RemoveEntry(0, 1, false);
+        entries[1].clip_id = -1;
+        is_same &= checkTrackEntries("remove without ripple", file, entries);
+    }
+
+    // Clips inserted into a blank, leaving blanks on both sides, on one side, and on neither
+    {
+        KdenliveFile file;
+        addTestTrack(file);
+        file.AddClipToTrack(0, 0, 2);
+        file.AddBlankToTrack(0, 3);
+        file.AddClipToTrack(0, 1, 1);
+        if(!file.IsTrackFree(0, 2, 3)  ||  file.IsTrackFree(0, 1.5f, 1)  ||  file.IsTrackFree(0, 4.5f, 1)  ||  !file.IsTrackFree(0, 6, 1)){
+            cerr << "MISMATCH: IsTrackFree() doesn't match the blank from 2 to 5\n";
+            is_same = false;
+        }
+
+        const TrackEntryId middle_id = file.InsertClipIntoTrack(0, 2, 3, 1);
+        is_same &= checkTrackEntries("insert into the middle of a blank", file, { {0, 2}, {-1, 1}, {2, 1}, {-1, 1}, {1, 1} });
+        const TrackEntryId start_id = file.InsertClipIntoTrack(0, 3, 2, 0.5f);
+        is_same &= checkTrackEntries("insert at the start of a blank", file, { {0, 2}, {3, 0.5f}, {-1, 0.5f}, {2, 1}, {-1, 1}, {1, 1} });
+        const TrackEntryId filling_id = file.InsertClipIntoTrack(0, 3, 4, 1);
+        is_same &= checkTrackEntries("insert filling a blank", file, { {0, 2}, {3, 0.5f}, {-1, 0.5f}, {2, 1}, {3, 1}, {1, 1} });
+        const TrackEntryId end_id = file.InsertClipIntoTrack(0, 0, 8, 1);
+        is_same &= checkTrackEntries("insert past the end", file, { {0, 2}, {3, 0.5f}, {-1, 0.5f}, {2, 1}, {3, 1}, {1, 1}, {-1, 2}, {0, 1} });
+        if(middle_id != 2  ||  start_id != 1  ||  filling_id != 4  ||  end_id != 7){
+            cerr << "MISMATCH: InsertClipIntoTrack() didn't return the TrackEntryId of the clip\n";
+            is_same = false;
+        }
+
+        if(file.InsertClipIntoTrack(0, 0, 2.25f, 1) != -1){
+            cerr << "MISMATCH: a clip overlapping the next entry should not be inserted\n";
+            is_same = false;
+        }
+        is_same &= checkTrackEntries("insert overlapping a clip", file, { {0, 2}, {3, 0.5f}, {-1, 0.5f}, {2, 1}, {3, 1}, {1, 1}, {-1, 2}, {0, 1} });
+    }
+
+    return is_same;
+}
+
+// Checks the volume filters of a small project, and that snapshots of earlier versions still load
+bool verifySnapshots(){
+    bool is_same = true;
+
+    KdenliveProject proj;
+    proj.CreateClipOnAudioTrack(0, "media_0", 2)->SetVolume(-6);
+    proj.CreateClipOnAudioTrack(2, "media_0", 2)->SetVolumeKeyframes({ {0, -3}, {1, -9} });
+    const string output = proj.SaveAsString({});
+    // Keyframes are in frames of the 30 fps profile of the project
+    if(output.find("<property name=\"level\">0=-6</property>") == string::npos
+       ||  output.find("<property name=\"level\">0=-3;30=-9</property>") == string::npos){
+        cerr << "MISMATCH: the volume filters should be at -6 dB, and from -3 dB down to -9 dB after 30 frames\n";
+        is_same = false;
+    }
+
+    // Each version only adds sections after the timelines, so a snapshot cut off before them, with its version set, is a snapshot of an earlier version.
+    // A clip named "media_0" on the video timeline takes the 56 byte header, 8 bytes of strings, 32 bytes for the clip, and 8 bytes for the timeline,
+    // which the volume of the clip follows
+    KdenliveProject plain_proj;
+    plain_proj.CreateClipOnVideoTrack(1, "media_0", 2);
+    const string snapshot_path = (fs::path(BENCHMARK_FOLDER) / "verify_version.kdnsnap").string();
+    plain_proj.SaveSnapshot(snapshot_path);
+    string snapshot;
+    {
+        ifstream input(snapshot_path, ios::binary);
+        snapshot.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+    const pair<char, size_t> earlier_versions[] = { {1, 104}, {2, 112}, {3, 112} };
+    for(const auto &earlier_version : earlier_versions){
+        const string check_name = "snapshot (version " + to_string(earlier_version.first) + ")";
+        string earlier_snapshot = snapshot.substr(0, earlier_version.second);
+        earlier_snapshot[8] = earlier_version.first;    // The version follows the magic, and is little-endian
+        ofstream(snapshot_path, ios::binary).write(earlier_snapshot.data(), earlier_snapshot.size());
+
+        KdenliveProject loaded_proj;
+        if(!loaded_proj.LoadSnapshot(snapshot_path)){
+            cerr << "MISMATCH: " << check_name << " should load\n";
+            is_same = false;
+        }
+        is_same &= checkSameOutput(check_name, 0, plain_proj.SaveAsString({}), loaded_proj.SaveAsString({}));
+    }
+    fs::remove(snapshot_path);
+
+    return is_same;
+}
+
+// Checks that music is lowered wherever dialog plays, with the dialog that is close enough together ducked as one range,
+// and that the audio roles are kept in a snapshot
+bool verifyDucking(){
+    KdenliveProject proj;
+    DuckingSettings ducking_settings;
+    ducking_settings.is_enabled = true;
+    proj.SetDuckingSettings(ducking_settings);
+    Clip* music_clip = proj.CreateClipOnAudioTrack(0, "media_0", 10);
+    music_clip->SetVolume(-2);
+    music_clip->SetAudioRole(Clip::MUSIC);
+    proj.CreateClipOnAudioTrack(3, "media_1", 2)->SetAudioRole(Clip::DIALOG);
+    proj.CreateClipOnAudioTrack(5.25f, "media_1", 0.75f)->SetAudioRole(Clip::DIALOG);
+    const string output = proj.SaveAsString({});
+
+    // Down by 12 dB from 3 to 6 seconds, fading over the quarter second before and after, in frames of the 30 fps profile
+    if(output.find("<property name=\"level\">0=-2;83=-2;90=-14;180=-14;188=-2;300=-2</property>") == string::npos){
+        cerr << "MISMATCH: music at -2 dB should be ducked to -14 dB from 3 to 6 seconds\n";
+        return false;
+    }
+
+    // The ducking settings aren't part of the snapshot
+    const string snapshot_path = (fs::path(BENCHMARK_FOLDER) / "verify_ducking.kdnsnap").string();
+    proj.SaveSnapshot(snapshot_path);
+    KdenliveProject loaded_proj;
+    loaded_proj.SetDuckingSettings(ducking_settings);
+    loaded_proj.LoadSnapshot(snapshot_path);
+    fs::remove(snapshot_path);
+
+    return checkSameOutput("snapshot (ducking)", 0, output, loaded_proj.SaveAsString({}));
+}
+
+// Checks that guides and the markers of each clip in the bin are added after the ones already there, on a file built directly
+bool verifyMarkers(){
+    KdenliveFile file;
+    const ClipId first_clip = file.AddClipToBin("media_folder/media_0.mp4");
+    const ClipId second_clip = file.AddClipToBin("media_folder/media_1.mp4");
+    file.AddClipMarkers(first_clip, { {0, "a", 0} });
+    file.AddClipMarkers(second_clip, { {0, "b", 1} });
+    file.AddClipMarkers(first_clip, { {1.001f, "c", 2} });
+    file.AddGuides({ {0, "d", 0} });
+    file.AddGuides({ {1.001f, "e", 1}, {2.002f, "f", 2} });
+    const string output = file.ToString();
+
+    // Setting the guides property replaces every guide added before
+    file.SetTimelineProperty("kdenlive:sequenceproperties.guides", "[]");
+    file.AddGuides({ {2.002f, "g", 0} });
+    const string replaced_output = file.ToString();
+
+    // Markers are placed on frames of the 29.97 fps profile of the template
+    if(output.find(">[{\"comment\":\"a\",\"pos\":0,\"type\":0},{\"comment\":\"c\",\"pos\":30,\"type\":2}]<") == string::npos
+       ||  output.find(">[{\"comment\":\"b\",\"pos\":0,\"type\":1}]<") == string::npos
+       ||  output.find(">[{\"comment\":\"d\",\"pos\":0,\"type\":0},{\"comment\":\"e\",\"pos\":30,\"type\":1},{\"comment\":\"f\",\"pos\":60,\"type\":2}]<") == string::npos
+       ||  replaced_output.find(">[{\"comment\":\"g\",\"pos\":60,\"type\":0}]<") == string::npos){
+        cerr << "MISMATCH: markers and guides should be added after the ones already in their property\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Checks that the fades of video and audio clips are loaded back from a saved project
+bool verifyLoadedFades(){
+    KdenliveProject proj;
+    Clip* video_clip = proj.CreateClip("media_0", 4, 1);
+    video_clip->SetFadeOffsets(0.5f, 1);
+    proj.AddClipToVideoTrack(0, video_clip);
+    Clip* audio_clip = proj.CreateClip("media_1", 3, 0);
+    audio_clip->SetFadeOffsets(1, 0.5f);
+    proj.AddClipToAudioTrack(2, audio_clip);
+    const string expected = proj.SaveAsString({});
+    proj.SaveToFile({}, "verify_fades", BENCHMARK_FOLDER);
+
+    KdenliveProject loaded_proj;
+    loaded_proj.LoadFromFile( (fs::path(BENCHMARK_FOLDER) / "verify_fades.kdenlive").string() );
+    return checkSameOutput("loaded fades", 0, expected, loaded_proj.SaveAsString({}));
+}
+
+// A file laid out the way Kdenlive saves it, at 25 fps, with frame counts for times and inclusive out points
+const char* KDENLIVE_FIXTURE =
+    "<?xml version='1.0' encoding='utf-8'?>\n"
+    "<mlt LC_NUMERIC='C' producer='main_bin' version='7.22.0'>\n"
+    " <profile frame_rate_num='25' frame_rate_den='1' width='1280' height='720' progressive='1'/>\n"
+    " <producer id='producer0' in='0' out='374'>\n"
+    "  <property name='resource'>black</property>\n"
+    "  <property name='kdenlive:playlistid'>black_track</property>\n"
+    " </producer>\n"
+    " <chain id='chain1' out='499'><property name='resource'>/footage/music.wav</property></chain>\n"
+    " <chain id='chain0' out='249'><property name='resource'>/footage/interview.mp4</property></chain>\n"
+    " <playlist id='playlist0'>\n"
+    "  <property name='kdenlive:audio_track'>1</property>\n"
+    "  <entry producer='chain1' in='0' out='249'>\n"
+    "   <filter id='filter2' in='200' out='249'><property name='kdenlive_id'>fadeout</property></filter>\n"
+    "  </entry>\n"
+    " </playlist>\n"
+    " <playlist id='playlist1'/>\n"
+    " <tractor id='tractor0'>\n"
+    "  <property name='kdenlive:audio_track'>1</property>\n"
+    "  <track producer='playlist0' hide='video'/>\n"
+    "  <track producer='playlist1' hide='video'/>\n"
+    " </tractor>\n"
+    " <playlist id='playlist2'>\n"
+    "  <blank length='25'/>\n"
+    "  <entry producer='chain0' in='50' out='149'>\n"
+    "   <filter id='filter0' in='50' out='62'><property name='kdenlive_id'>fade_from_black</property></filter>\n"
+    "  </entry>\n"
+    "  <entry producer='chain0' in='0' out='24'>\n"
+    "   <filter id='filter1' in='0' out='24'><property name='kdenlive_id'>volume</property></filter>\n"
+    "  </entry>\n"
+    " </playlist>\n"
+    " <playlist id='playlist3'/>\n"
+    " <tractor id='tractor1'>\n"
+    "  <track producer='playlist2' hide='audio'/>\n"
+    "  <track producer='playlist3' hide='audio'/>\n"
+    " </tractor>\n"
+    " <tractor id='{9b3c1e2a-5d4f-4a6b-8c7d-0e1f2a3b4c5d}' in='0' out='374'>\n"
+    "  <track producer='producer0'/>\n"
+    "  <track producer='tractor0'/>\n"
+    "  <track producer='tractor1'/>\n"
+    " </tractor>\n"
+    " <playlist id='main_bin'>\n"
+    "  <property name='kdenlive:docproperties.uuid'>{9b3c1e2a-5d4f-4a6b-8c7d-0e1f2a3b4c5d}</property>\n"
+    "  <entry producer='{9b3c1e2a-5d4f-4a6b-8c7d-0e1f2a3b4c5d}' in='0' out='0'/>\n"
+    "  <entry producer='chain0' in='0' out='0'/>\n"
+    "  <entry producer='chain1' in='0' out='0'/>\n"
+    " </playlist>\n"
+    " <tractor id='final_tractor' in='0' out='374'><track producer='{9b3c1e2a-5d4f-4a6b-8c7d-0e1f2a3b4c5d}'/></tractor>\n"
+    "</mlt>\n";
+
+// Checks that a file saved by Kdenlive loads into the clips it shows, and that a file without a timeline leaves the project as it was
+bool verifyLoadedKdenliveFile(){
+    const string fixture_path = (fs::path(BENCHMARK_FOLDER) / "verify_fixture.kdenlive").string();
+    ofstream(fixture_path) << KDENLIVE_FIXTURE;
+
+    // Each entry lasts out - in + 1 frames, and the clips are created in the order of the bin
+    KdenliveProject proj;
+    proj.SetProfile(25, 1280, 720);
+    Clip* first_clip = proj.CreateClip("interview", 4, 2);
+    first_clip->SetFadeOffsets(0.52f, 0);
+    proj.AddClipToVideoTrack(1, first_clip);
+    proj.AddClipToVideoTrack(5, proj.CreateClip("interview", 1, 0));
+    Clip* music_clip = proj.CreateClip("music", 10, 0);
+    music_clip->SetFadeOffsets(0, 2);
+    proj.AddClipToAudioTrack(0, music_clip);
+    const string expected = proj.SaveAsString({});
+
+    KdenliveProject loaded_proj;
+    bool is_same = loaded_proj.LoadFromFile(fixture_path);
+    is_same &= checkSameOutput("Kdenlive file", 0, expected, loaded_proj.SaveAsString({}));
+
+    const string no_timeline_path = (fs::path(BENCHMARK_FOLDER) / "verify_no_timeline.kdenlive").string();
+    ofstream(no_timeline_path) << "<mlt><profile frame_rate_num='50' frame_rate_den='1' width='640' height='480'/></mlt>";
+    // The error is expected, so it isn't printed
+    streambuf* cerr_buffer = cerr.rdbuf(nullptr);
+    const bool is_loaded = loaded_proj.LoadFromFile(no_timeline_path);
+    cerr.rdbuf(cerr_buffer);
+    if(is_loaded){
+        cerr << "MISMATCH: a file without a timeline should not be loaded\n";
+        is_same = false;
+    }
+    is_same &= checkSameOutput("Kdenlive file (not replaced)", 0, expected, loaded_proj.SaveAsString({}));
+
+    fs::remove(fixture_path);
+    fs::remove(no_timeline_path);
+    return is_same;
+}
+
+// Checks that sequences can share the projects they play, but never play each other
+bool verifySequences(){
+    bool is_same = true;
+
+    // Both sequences played by the main project play the same inner project
+    KdenliveProject inner_proj;
+    inner_proj.CreateClipOnVideoTrack(0, "media_0", 2);
+    KdenliveProject first_proj;
+    first_proj.AddClipToVideoTrack(0, first_proj.CreateSequenceClip("inner", &inner_proj, 2));
+    KdenliveProject second_proj;
+    second_proj.AddClipToVideoTrack(0, second_proj.CreateSequenceClip("inner", &inner_proj, 2));
+    KdenliveProject proj;
+    proj.AddClipToVideoTrack(0, proj.CreateSequenceClip("first", &first_proj, 2));
+    proj.AddClipToVideoTrack(2, proj.CreateSequenceClip("second", &second_proj, 2));
+
+    // Playing any of them from a project they play would loop forever, however far down the loop closes
+    // The errors are expected, so they aren't printed
+    streambuf* cerr_buffer = cerr.rdbuf(nullptr);
+    const bool is_loop_rejected = inner_proj.CreateSequenceClip("loop", &inner_proj, 2) == nullptr
+                                  &&  inner_proj.CreateSequenceClip("loop", &first_proj, 2) == nullptr
+                                  &&  inner_proj.CreateSequenceClip("loop", &proj, 2) == nullptr;
+    cerr.rdbuf(cerr_buffer);
+    if(!is_loop_rejected){
+        cerr << "MISMATCH: sequences that play each other should be rejected\n";
+        is_same = false;
+    }
+    if(first_proj.CreateSequenceClip("sibling", &second_proj, 2) == nullptr){
+        cerr << "MISMATCH: a sequence that doesn't play this project should be accepted\n";
+        is_same = false;
+    }
+
+    // The hash of a project includes the projects it plays, however many clips play them
+    const uint64_t hash = proj.ComputeHash({});
+    is_same &= !proj.SaveAsString({}).empty();
+    if(proj.ComputeHash({}) != hash){
+        cerr << "MISMATCH: the hash of a project with sequences changed without any change to it\n";
+        is_same = false;
+    }
+    inner_proj.CreateClipOnVideoTrack(2, "media_1", 1);
+    if(proj.ComputeHash({}) == hash){
+        cerr << "MISMATCH: the hash of a project didn't change when a sequence it plays changed\n";
+        is_same = false;
+    }
+
+    return is_same;
+}
+
+// Checks every other way of generating the project against generating it from scratch
+bool verifyRandomProject(const uint32_t seed, const int clip_count){
+    const vector<RandomClip> clips = createRandomClips(seed, clip_count);
+    const string expected = generateOutput(clips);
+    bool is_same = true;
+
+    // Incremental generation, after adding the second half of the clips, and then after changing the first clip
+    {
+        KdenliveProject proj;
+        proj.SetIncrementalGeneration(true);
+        const vector<RandomClip> first_half(clips.begin(), clips.begin() + clips.size() / 2);
+        const vector<Clip*> first_half_clips = addRandomClips(proj, first_half);
+        is_same &= checkSameOutput("incremental (first half)", seed, generateOutput(first_half), proj.SaveAsString({}));
+
+        addRandomClips(proj, vector<RandomClip>(clips.begin() + clips.size() / 2, clips.end()));
+        is_same &= checkSameOutput("incremental", seed, expected, proj.SaveAsString({}));
+        is_same &= checkSameOutput("incremental (unchanged)", seed, expected, proj.SaveAsString({}));
+
+        if(!first_half_clips.empty()){
+            vector<RandomClip> changed_clips = clips;
+            changed_clips[0].fade_in_time = 0.25f;
+            changed_clips[0].length += 1;
+            first_half_clips[0]->SetFadeOffsets(changed_clips[0].fade_in_time, changed_clips[0].fade_out_time);
+            first_half_clips[0]->SetBounds(changed_clips[0].length, changed_clips[0].start_offset);
+            is_same &= checkSameOutput("incremental (changed)", seed, generateOutput(changed_clips), proj.SaveAsString({}));
+        }
+    }
+
+    // Incremental generation while filling gaps, where each clip added after the first half is inserted into its track
+    {
+        KdenliveProject proj;
+        proj.SetIncrementalGeneration(true);
+        proj.SetFillGaps(true);
+        vector<RandomClip> added_clips(clips.begin(), clips.begin() + clips.size() / 2);
+        addRandomClips(proj, added_clips);
+        proj.SaveAsString({});
+
+        vector<RandomClip> next_clip(1);
+        for(size_t i = added_clips.size(); i < clips.size()  &&  i < clips.size() / 2 + 10; i++){
+            next_clip[0] = clips[i];
+            addRandomClips(proj, next_clip);
+            added_clips.push_back(clips[i]);
+            is_same &= checkSameOutput("incremental (filling gaps)", seed, generateOutput(added_clips, true), proj.SaveAsString({}));
+        }
+    }
+
+    // Snapshot round trip
+    {
+        const string snapshot_path = (fs::path(BENCHMARK_FOLDER) / "verify.kdnsnap").string();
+        KdenliveProject proj;
+        addRandomClips(proj, clips);
+        proj.SaveSnapshot(snapshot_path);
+
+        KdenliveProject loaded_proj;
+        loaded_proj.LoadSnapshot(snapshot_path);
+        is_same &= checkSameOutput("snapshot", seed, expected, loaded_proj.SaveAsString({}));
+        fs::remove(snapshot_path);
+    }
+
+    // Snapshot round trip and incremental generation with volumes, audio roles, markers, and guides
+    {
+        const string snapshot_path = (fs::path(BENCHMARK_FOLDER) / "verify_audio.kdnsnap").string();
+        KdenliveProject proj;
+        setRandomAudio(proj, addRandomClips(proj, clips), 0);
+        if(!proj.SaveSnapshot(snapshot_path)){
+            cerr << "MISMATCH: snapshot with seed " << seed << " should save the volumes, roles, and markers of the clips\n";
+            is_same = false;
+        }
+
+        KdenliveProject loaded_proj;
+        loaded_proj.LoadSnapshot(snapshot_path);
+        is_same &= checkSameOutput("snapshot (volumes and markers)", seed, proj.SaveAsString({}), loaded_proj.SaveAsString({}));
+        fs::remove(snapshot_path);
+
+        is_same &= checkIncrementalOutput("incremental (volumes and markers)", seed, clips, setRandomAudio);
+        is_same &= checkIncrementalOutput("incremental (ducking)", seed, clips,
+                                          [](KdenliveProject &proj, const vector<Clip*> &created_clips, size_t first_index){
+            DuckingSettings ducking_settings;
+            ducking_settings.is_enabled = true;
+            proj.SetDuckingSettings(ducking_settings);
+            setRandomAudio(proj, created_clips, first_index);
+        });
+    }
+
+    // Time queries, and again after some clips get longer, which must refresh the end times of the index before the next query finds them
+    {
+        KdenliveProject proj;
+        const vector<Clip*> created_clips = addRandomClips(proj, clips);
+        is_same &= checkTimeQueries("time queries", seed, proj, clips, created_clips);
+
+        vector<RandomClip> changed_clips = clips;
+        for(size_t i = 0; i < changed_clips.size(); i += 3){
+            changed_clips[i].length *= 3;
+            created_clips[i]->SetBounds(changed_clips[i].length, changed_clips[i].start_offset);
+        }
+        is_same &= checkTimeQueries("time queries (changed lengths)", seed, proj, changed_clips, created_clips);
+    }
+
+    // Video clips layered by priority
+    {
+        mt19937 rng(seed);
+        const vector<RandomClip> video_clips = selectVideoClips(clips);
+        vector<int> priorities;
+        for(size_t i = 0; i < video_clips.size(); i++)
+            priorities.push_back(rng() % 4);
+
+        // Clips are only layered when they have different priorities
+        if(!priorities.empty()  &&  count(priorities.begin(), priorities.end(), priorities[0]) != static_cast<long>(priorities.size())){
+            KdenliveProject proj;
+            const vector<Clip*> created_clips = addRandomClips(proj, video_clips);
+            for(size_t i = 0; i < created_clips.size(); i++)
+                created_clips[i]->SetPriority(priorities[i]);
+            is_same &= checkPriorityLayout("priority layout", seed, video_clips, priorities, proj.SaveAsString({}));
+        }
+    }
+
+    // Clips that overlap briefly placed on the same track, from scratch and incrementally
+    is_same &= checkMixedLayout(seed, clips);
+    is_same &= checkIncrementalOutput("incremental (mixes)", seed, clips, [](KdenliveProject &proj, const vector<Clip*> &, size_t){
+        MixSettings mix_settings;
+        mix_settings.max_overlap_length = 1;
+        proj.SetMixSettings(mix_settings);
+    });
+
+    // Crossfades between overlapping clips on different tracks, counted in the stats, and generated incrementally
+    {
+        KdenliveProject proj;
+        proj.SetCrossfades(true);
+        addRandomClips(proj, clips);
+        GenerationStats stats;
+        const int transition_count = countTimedTransitions( proj.SaveAsString({}, &stats) );
+        if(stats.transitions_emitted != transition_count  ||  transition_count > static_cast<int>(2 * clips.size())){
+            cerr << "MISMATCH: crossfades with seed " << seed << " add " << transition_count << " transitions, but count "
+                 << stats.transitions_emitted << " in the stats\n";
+            is_same = false;
+        }
+        is_same &= checkIncrementalOutput("incremental (crossfades)", seed, clips, [](KdenliveProject &proj, const vector<Clip*> &, size_t){
+            proj.SetCrossfades(true);
+        });
+    }
+
+    // Render zones of the whole project, where the clips longer than 5 seconds may be cut
+    {
+        KdenliveProject proj;
+        addRandomClips(proj, clips);
+        const int zone_count = 1 + seed % 8;
+        is_same &= checkRenderZones("render zones", seed, proj.ComputeRenderZones(zone_count), clips, zone_count, 5);
+    }
+
+    // Manifest import
+    {
+        const string manifest_path = (fs::path(BENCHMARK_FOLDER) / "verify.csv").string();
+        saveRandomClipsAsManifest(clips, manifest_path);
+
+        KdenliveProject proj;
+        proj.ImportManifest(manifest_path);
+        is_same &= checkSameOutput("manifest", seed, expected, proj.SaveAsString({}));
+        fs::remove(manifest_path);
+    }
+
+    // Project file round trip, where the saved file is loaded back into a new project
+    {
+        KdenliveProject proj;
+        addRandomClips(proj, clips);
+        proj.SaveToFile({}, "verify_load", BENCHMARK_FOLDER);
+
+        const string file_path = (fs::path(BENCHMARK_FOLDER) / "verify_load.kdenlive").string();
+        KdenliveProject loaded_proj;
+        loaded_proj.LoadFromFile(file_path);
+        is_same &= checkSameOutput("loaded project file", seed, expected, loaded_proj.SaveAsString({}));
+        fs::remove(file_path);
+    }
+
+    return is_same;
+}
+
+int runVerification(const int random_seed_count){
+    fs::create_directories(BENCHMARK_FOLDER);
+    bool is_verified = true;
+
+    for(const GoldenOutput &golden : GOLDEN_OUTPUTS){
+        const string output = generateOutput( createRandomClips(golden.seed, golden.clip_count) );
+        if(output.size() != golden.size  ||  hashOutput(output) != golden.hash){
+            cerr << "MISMATCH: golden output with seed " << golden.seed << " is now { " << golden.seed << ", " << golden.clip_count
+                 << ", " << output.size() << ", 0x" << hex << hashOutput(output) << dec << "ULL }\n";
+            is_verified = false;
+        }
+    }
+
+    is_verified &= verifyRenderJobs();
+    is_verified &= verifyTrackEdits();
+    is_verified &= verifyMixes();
+    is_verified &= verifyCrossfades();
+    is_verified &= verifySnapshots();
+    is_verified &= verifyDucking();
+    is_verified &= verifyMarkers();
+    is_verified &= verifyLoadedFades();
+    is_verified &= verifyLoadedKdenliveFile();
+    is_verified &= verifySequences();
+    for(int seed = 0; seed < random_seed_count; seed++)
+        is_verified &= verifyRandomProject(seed, 1 + seed * 7 % 400);
+
+    fs::remove_all(BENCHMARK_FOLDER);
+
+    cerr << (is_verified ? "All outputs match\n" : "Outputs differ\n");
+    return is_verified ? 0 : 1;
+}
+
+
+int runAllocationReport(const int clip_count, const string &output_path){
+    vector<AllocationResult> results;
+
+    for(const Workload &workload : createWorkloads())
+        runWorkloadAllocations(workload, clip_count, results);
+    runKdenliveFileAllocations(results);
+
+    // Write the results
+    const string json = convertAllocationResultsToJson(results);
+    if(output_path != "")
+        ofstream(output_path) << json;
+    else
+        cout << json;
+
+    return checkAllocationBudgets(results) ? 0 : 1;
+}
+
+
+int main(int argc, char** argv){
+    if(argc > 1  &&  string(argv[1]) == "--allocations")
+        return runAllocationReport( (argc > 2) ? stoi(argv[2]) : 10000, (argc > 3) ? argv[3] : "" );
+    if(argc > 1  &&  string(argv[1]) == "--verify")
+        return runVerification( (argc > 2) ? stoi(argv[2]) : 100 );
+
+    const int max_clip_count = (argc > 1) ? stoi(argv[1]) : 1000000;
+    const string output_path = (argc > 2) ? argv[2] : "";
+
+    fs::create_directories(BENCHMARK_FOLDER);
+    vector<BenchmarkResult> results;
+
+    for(const Workload &workload : createWorkloads()){
+        for(int clip_count = 1000; clip_count <= max_clip_count; clip_count *= 10){
+            cerr << "Running " << workload.name << " with " << clip_count << " clips\n";
+            runWorkload(workload, clip_count, results);
+        }
+    }
+
+    runFindFilePath(results);
+    for(int row_count = 1000; row_count <= max_clip_count; row_count *= 10)
+        runImportManifest(row_count, results);
+
+    fs::remove_all(BENCHMARK_FOLDER);
+
+    // Write the results
+    const string json = convertResultsToJson(results);
+    if(output_path != "")
+        ofstream(output_path) << json;
+    else
+        cout << json;
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include <charconv>
+#include <cstring>
+#include "JsonWriter.h"
+
+using namespace std;
+
+
+// CONSTRUCTORS
+JsonWriter::JsonWriter(){
+    buffer.push_back('\0');
+    has_values = 0;
+    depth = 0;
+    is_after_key = false;
+}
+
+
+// SETTERS
+void JsonWriter::Clear(){
+    buffer.clear();
+    buffer.push_back('\0');
+    has_values = 0;
+    depth = 0;
+    is_after_key = false;
+}
+
+bool JsonWriter::ReopenArray(const char* array_text){
+    Clear();
+
+    // The array runs from the first non-space character to the last ']'
+    const char* begin = array_text;
+    while(*begin == ' '  ||  *begin == '\t'  ||  *begin == '\n'  ||  *begin == '\r')
+        begin++;
+    const char* end = strrchr(begin, ']');
+    if(*begin != '['  ||  end == nullptr)
+        return false;
+
+    // Leave off the space before the bracket, so the values added next follow the last value directly
+    while(end > begin + 1  &&  (end[-1] == ' '  ||  end[-1] == '\t'  ||  end[-1] == '\n'  ||  end[-1] == '\r'))
+        end--;
+    Append(begin, end - begin);
+    depth = 1;
+    has_values = (end > begin + 1) ? (1ULL << depth) : 0;
+
+    return true;
+}
+
+bool JsonWriter::ReopenArray(){
+    const size_t size = Size();
+    if(depth != 0  ||  size < 2  ||  buffer[0] != '['  ||  buffer[size - 1] != ']')
+        return false;
+
+    // Only the closing bracket is removed, which never allocates
+    buffer.erase(buffer.end() - 2);
+    depth = 1;
+    has_values = (size > 2) ? (1ULL << depth) : 0;
+
+    return true;
+}
+
+void JsonWriter::BeginArray(){
+    BeginValue();
+    Append("[", 1);
+    depth++;
+    has_values &= ~(1ULL << depth);
+}
+
+void JsonWriter::EndArray(){
+    Append("]", 1);
+    depth--;
+}
+
+void JsonWriter::BeginObject(){
+    BeginValue();
+    Append("{", 1);
+    depth++;
+    has_values &= ~(1ULL << depth);
+}
+
+void JsonWriter::EndObject(){
+    Append("}", 1);
+    depth--;
+}
+
+void JsonWriter::AddKey(const char* key){
+    BeginValue();
+    Append("\"", 1);
+    AppendEscaped(key, strlen(key));
+    Append("\":", 2);
+    is_after_key = true;
+}
+
+void JsonWriter::AddString(const char* value, const size_t length){
+    BeginValue();
+    Append("\"", 1);
+    AppendEscaped(value, length);
+    Append("\"", 1);
+}
+
+void JsonWriter::AddString(const string &value){
+    AddString(value.data(), value.size());
+}
+
+void JsonWriter::AddInt(const long long value){
+    BeginValue();
+    char int_str[24];
+    const char* int_end = to_chars(int_str, int_str + sizeof(int_str), value).ptr;
+    Append(int_str, int_end - int_str);
+}
+
+
+// GETTERS
+const char* JsonWriter::CStr() const{
+    return buffer.data();
+}
+
+size_t JsonWriter::Size() const{
+    return buffer.size() - 1;
+}
+
+
+// HELPERS
+// Adds the comma before every value of an array or object but the first, except for the value of a key
+void JsonWriter::BeginValue(){
+    if(is_after_key){
+        is_after_key = false;
+        return;
+    }
+    if(depth == 0)
+        return;
+
+    const uint64_t depth_bit = 1ULL << depth;
+    if(has_values & depth_bit)
+        Append(",", 1);
+    has_values |= depth_bit;
+}
+
+void JsonWriter::Append(const char* text, const size_t length){
+    // Insert before the null character, which only allocates when the buffer first grows this large
+    buffer.insert(buffer.end() - 1, text, text + length);
+}
+
+void JsonWriter::AppendEscaped(const char* text, const size_t length){
+    // Copy the characters that need no escaping in runs, between the ones that do
+    size_t run_start = 0;
+    for(size_t i = 0; i < length; i++){
+        const unsigned char c = text[i];
+        if(c >= 0x20  &&  c != '"'  &&  c != '\\')
+            continue;
+
+        Append(text + run_start, i - run_start);
+        run_start = i + 1;
+        switch(c){
+            case '"':   Append("\\\"", 2);  break;
+            case '\\':  Append("\\\\", 2);  break;
+            case '\n':  Append("\\n", 2);   break;
+            case '\r':  Append("\\r", 2);   break;
+            case '\t':  Append("\\t", 2);   break;
+            case '\b':  Append("\\b", 2);   break;
+            case '\f':  Append("\\f", 2);   break;
+            default:{
+                // Other control characters have no short form
+                const char* HEX_DIGITS = "0123456789abcdef";
+                const char escape[6] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xf] };
+                Append(escape, sizeof(escape));
+            }
+        }
+    }
+    Append(text + run_start, length - run_start);
+}
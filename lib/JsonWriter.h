@@ -0,0 +1,60 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// Writes JSON text one value at a time, adding the commas between values and escaping strings as they are written.
+// The buffer is kept between documents, so once it is large enough, writing a document doesn't allocate.
+// Arrays and objects can be nested up to 63 deep.
+class JsonWriter{
+    public:
+    // CONSTRUCTORS
+    JsonWriter();
+
+    // SETTERS
+    /** Starts a new document, keeping the buffer of the last one.
+     */
+    void Clear();
+    /** Starts a new document from the text of an array written before, so values can be added to the end of it.
+     *  Returns false, and leaves the document empty, if the text isn't an array.
+     */
+    bool ReopenArray(const char* array_text);
+    /** Reopens the array that is the whole of the current document, so values can be added to the end of it without copying it again.
+     *  Returns false, and leaves the document as it is, if the document isn't a finished array.
+     */
+    bool ReopenArray();
+    void BeginArray();
+    void EndArray();
+    void BeginObject();
+    void EndObject();
+    /** Adds the key of the next value of an object.
+     */
+    void AddKey(const char* key);
+    void AddString(const char* value, const size_t length);
+    void AddString(const std::string &value);
+    void AddInt(const long long value);
+
+    // GETTERS
+    /** Returns the document, which is valid until the writer is next changed.
+     */
+    const char* CStr() const;
+    size_t Size() const;
+
+
+    private:
+    void BeginValue();
+    void Append(const char* text, const size_t length);
+    void AppendEscaped(const char* text, const size_t length);
+
+    // PRIVATE VARIABLES
+    std::vector<char> buffer;       // Always ends with a null character, which is not counted by Size()
+    uint64_t has_values;            // Whether each open array or object has a value yet, one bit per level of nesting
+    int depth;
+    bool is_after_key;
+};
+
+
+#endif
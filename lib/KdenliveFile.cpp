@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <cmath>
+#include <cstring>
 #include "KdenliveFile.h"
+#include "Latency.h"
+#include "Trace.h"
 
 using namespace std;
 using namespace tinyxml2;
@@ -12,6 +16,9 @@ using namespace tinyxml2;
 // Using this library to modify a file that has already been edited in will not work, as Kdenlive generates a lot of data that we don't generate here.
 const char* EMPTY_PROJECT_FILEPATH = "dependencies/empty_project.kdenlive";
 
+const char* GUIDES_PROPERTY_NAME = "kdenlive:sequenceproperties.guides";
+const float GAP_TOLERANCE = 0.0005f;    // Clips may overlap a gap by this much, which is less than a timestamp can show
+
 
 ifstream openInputFile(const string &file_path){
 	//open file
@@ -37,6 +44,33 @@ string readEntireFile(ifstream &input_file){
 	return string(istreambuf_iterator<char>(input_file), istreambuf_iterator<char>());
 }
 
+uint64_t mixUUIDBits(uint64_t value){
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// Creates a UUID in the format Kdenlive uses, that is the same every time for the same document and sequence
+string createSequenceUUID(const string &doc_uuid, const int sequence_index){
+    // FNV-1a of the document's UUID, followed by the index of the sequence
+    uint64_t hash = 14695981039346656037ULL;
+    const string seed = doc_uuid + "/" + to_string(sequence_index);
+    for(const char c : seed){
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    // Mix the bits, so that sequences of the same document don't have similar UUIDs
+    hash = mixUUIDBits(hash);
+    const uint64_t hash_2 = mixUUIDBits(hash + 0x9e3779b97f4a7c15ULL);
+
+    // Mark it as a version 4 UUID
+    char uuid[40];
+    snprintf(uuid, sizeof(uuid), "{%08x-%04x-4%03x-%04x-%012llx}",
+             static_cast<unsigned int>(hash >> 32), static_cast<unsigned int>(hash >> 16) & 0xffff, static_cast<unsigned int>(hash) & 0x0fff,
+             (static_cast<unsigned int>(hash_2 >> 48) & 0x3fff) | 0x8000, static_cast<unsigned long long>(hash_2) & 0xffffffffffffULL);
+    return uuid;
+}
+
 string convertToTimestamp(float seconds){
     // Calculate hours, minutes, seconds, and milliseconds
     int hours = static_cast<int>(seconds) / 3600;
@@ -56,6 +90,11 @@ string convertToTimestamp(float seconds){
     return ss.str();
 }
 
+// MLT's out points are inclusive, so an element that ends at end_time is written with the timestamp of its last frame
+string convertToOutTimestamp(const float end_time, const float framerate){
+    return convertToTimestamp( max(end_time - 1 / framerate, 0.0f) );
+}
+
 
 // CONSTRUCTORS
 KdenliveFile::KdenliveFile(){
@@ -63,11 +102,14 @@ KdenliveFile::KdenliveFile(){
     chain_count = 0;
     track_count = 0;
     filter_count = 0;
+    transition_count = 0;
     track_lengths = vector<float>();
-    track_entries = vector<vector<TrackEntry>>();
+    track_entries = vector<TrackIndex>();
+    track_playlists = vector<XMLElement*>();
     
     // Get "empty" kdenlive file a string and parse it
     {
+    KDENCODE_TRACE_SCOPE("KdenliveFile::LoadTemplate");
     ifstream input_file = openInputFile(EMPTY_PROJECT_FILEPATH);
     static const string empty_project_string = readEntireFile(input_file);
     input_file.close(); 
@@ -88,18 +130,26 @@ KdenliveFile::KdenliveFile(){
     // Find the timeline tractor, which holds every track
     string timeline_tractor_id = FindDocUUID();
     timeline_tractor = FindTractorElement(timeline_tractor_id.c_str());
+    // The timeline already has transitions between its tracks, so new transitions are numbered after them
+    for(XMLElement* ptr = timeline_tractor->FirstChildElement("transition"); ptr != nullptr; ptr = ptr->NextSiblingElement("transition"))
+        transition_count++;
 
     // Set the final tractor
     final_tractor = main_bin->NextSiblingElement();
     final_tractor->SetAttribute("id", "final_tractor");
+    render_consumer = nullptr;
 
     // The element we want to start adding after is the producer
     last_added_root_element = main_producer;
+    last_added_sequence_element = main_producer;
+    sequence_tractors.push_back(timeline_tractor);
 
 
     // Delete all the tracks the Kdenlive pre-generate in new files
     // We do this so we don't have to manually modify the generated empty file to get a file with 0 tracks
     DeletePreExistingTracks();
+    // Only the black track is left
+    sequence_track_counts.push_back(1);
 }
 
 
@@ -125,7 +175,69 @@ void KdenliveFile::SetProfile(const int framerate, const int width, const int he
     main_bin->DeleteChild(profile_property);
 }
 
-TrackId KdenliveFile::AddTrack(const TrackType track_type){
+void KdenliveFile::SetBinProperty(const char* name, const char* value){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::SetBinProperty");
+
+    SetPropertyElement(main_bin, name, value);
+}
+
+void KdenliveFile::SetTimelineProperty(const char* name, const char* value){
+    SetPropertyElement(timeline_tractor, name, value);
+
+    // The guides are read back from the property the next time any are added
+    if(strcmp(name, GUIDES_PROPERTY_NAME) == 0)
+        guides_writer.Clear();
+}
+
+void KdenliveFile::SetRenderZone(const int in_frame, const int out_frame){
+    final_tractor->SetAttribute("in", in_frame);
+    final_tractor->SetAttribute("out", out_frame);
+}
+
+void KdenliveFile::SetRenderTarget(const string &target){
+    if(render_consumer == nullptr){
+        render_consumer = xml_doc.NewElement("consumer");
+        render_consumer->SetAttribute("mlt_service", "avformat");
+        // Render every frame, using as many threads as are available
+        render_consumer->SetAttribute("real_time", -1);
+        root->InsertEndChild(render_consumer);
+    }
+
+    render_consumer->SetAttribute("target", target.c_str());
+}
+
+void KdenliveFile::SetClipProxy(const ClipId clip_id, const string &proxy_path){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::SetClipProxy");
+
+    XMLElement* chain = bin_chains[clip_id];
+    XMLElement* proxy = FindPropertyElement(chain, "kdenlive:proxy");
+    XMLElement* original_url = FindPropertyElement(chain, "kdenlive:originalurl");
+
+    // Remove the proxy
+    if(proxy_path.empty()){
+        if(proxy != nullptr)
+            chain->DeleteChild(proxy);
+        if(original_url != nullptr)
+            chain->DeleteChild(original_url);
+        return;
+    }
+
+    // Kdenlive keeps the path of the original file, so it can switch back when proxies are disabled
+    if(original_url == nullptr){
+        const XMLElement* resource = FindPropertyElement(chain, "resource");
+        AddPropertyElement(chain, "kdenlive:originalurl", resource->GetText());
+    }
+
+    if(proxy != nullptr)
+        proxy->SetText(proxy_path.c_str());
+    else
+        AddPropertyElement(chain, "kdenlive:proxy", proxy_path.c_str());
+}
+
+TrackId KdenliveFile::AddTrack(const TrackType track_type, const SequenceId sequence_id){
+    KDENCODE_TRACE_SCOPE("KdenliveFile::AddTrack");
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddTrack");
+
     // Add two playlists
     int playlist_index_1 = (track_count) * 2;
     int playlist_index_2 = playlist_index_1 + 1;
@@ -133,14 +245,14 @@ TrackId KdenliveFile::AddTrack(const TrackType track_type){
     string playlist_str_2 = "playlist" + to_string(playlist_index_2);
 
     XMLElement* playlist_1 = CreatePlaylistElement(playlist_str_1.c_str());
-    AddElementToRoot(playlist_1);
+    AddElementToSequence(sequence_id, playlist_1);
     XMLElement* playlist_2 = CreatePlaylistElement(playlist_str_2.c_str());
-    AddElementToRoot(playlist_2);
+    AddElementToSequence(sequence_id, playlist_2);
 
     // Add a tractor
     string tractor_str = "tractor" + to_string(track_count);
     XMLElement* tractor = CreateTractorElement(tractor_str.c_str());
-    AddElementToRoot(tractor);
+    AddElementToSequence(sequence_id, tractor);
 
     // Add playlists to tractor as tracks
     XMLElement* track_1 = AddTrackElement(tractor, playlist_str_1.c_str());
@@ -163,27 +275,74 @@ TrackId KdenliveFile::AddTrack(const TrackType track_type){
 
     }
 
-    // Add tractor to timeline as a track
-    AddTrackElement(timeline_tractor, tractor_str.c_str());
+    // Add tractor to the sequence's timeline as a track
+    AddTrackElement(sequence_tractors[sequence_id], tractor_str.c_str());
+    track_positions.push_back(sequence_track_counts[sequence_id]);
+    sequence_track_counts[sequence_id]++;
 
     // Set internal data
     track_count ++;
     track_lengths.push_back(0);
-    track_entries.push_back( vector<TrackEntry>() );
+    track_entries.push_back( TrackIndex() );
+    track_playlists.push_back(playlist_1);
+    mix_playlists.push_back(playlist_2);
+    mix_playlist_lengths.push_back(0);
+    mix_playlist_clips.emplace_back();
+    track_tractors.push_back(tractor);
+    track_types.push_back(track_type);
+    track_volume_filters.push_back(nullptr);
+    track_sequences.push_back(sequence_id);
+    track_has_transitions.push_back(false);
 
     return track_count - 1;
 }
 
+SequenceId KdenliveFile::AddSequence(const string &name){
+    KDENCODE_TRACE_SCOPE("KdenliveFile::AddSequence");
+
+    // Derive the UUID from the document's, so the same file is generated every time
+    const SequenceId sequence_id = sequence_tractors.size();
+    const string uuid = createSequenceUUID(FindDocUUID(), sequence_id);
+
+    XMLElement* sequence = CreateTractorElement(uuid.c_str());
+    sequence->SetAttribute("in", "00:00:00.000");
+    AddPropertyElement(sequence, "kdenlive:uuid", uuid.c_str());
+    AddPropertyElement(sequence, "kdenlive:clipname", name.c_str());
+    AddPropertyElement(sequence, "kdenlive:producer_type", "17");
+    AddPropertyElement(sequence, "kdenlive:folderid", "2");     // The "Sequences" folder of the bin
+    AddPropertyElement(sequence, "kdenlive:sequenceproperties.hasAudio", "1");
+    AddPropertyElement(sequence, "kdenlive:sequenceproperties.hasVideo", "1");
+    // Like the main timeline, the bottom track is the black background
+    AddTrackElement(sequence, main_producer->Attribute("id"));
+
+    root->InsertAfterChild(last_added_sequence_element, sequence);
+    if(last_added_root_element == last_added_sequence_element)
+        last_added_root_element = sequence;
+    last_added_sequence_element = sequence;
+
+    // Add entry to main bin
+    AddEntryElement(main_bin, 0, 0, uuid.c_str());
+
+    sequence_tractors.push_back(sequence);
+    sequence_track_counts.push_back(1);
+
+    return sequence_id;
+}
+
 ClipId KdenliveFile::AddClipToBin(const std::string &clip_path){
+    KDENCODE_TRACE_SCOPE("KdenliveFile::AddClipToBin");
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddClipToBin");
+
     // Create chain
-    const char* chain_name = ("chain" + to_string(chain_count)).c_str();
-    XMLElement* chain =  CreateChainElement(chain_name, clip_path.c_str());
+    const string chain_name = "chain" + to_string(chain_count);
+    XMLElement* chain =  CreateChainElement(chain_name.c_str(), clip_path.c_str());
     
     // Add chain above all playlists and tractors
     AddElementToTopOfRoot(chain);
+    bin_chains.push_back(chain);
 
     // Add entry to main bin
-    AddEntryElement(main_bin, 0, 0, chain_name);
+    AddEntryElement(main_bin, 0, 0, chain_name.c_str());
 
     // Set internal data
     chain_count++;
@@ -192,93 +351,403 @@ ClipId KdenliveFile::AddClipToBin(const std::string &clip_path){
 }
 
 TrackEntryId KdenliveFile::AddBlankToTrack(const TrackId track_id, const float length){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddBlankToTrack");
+
     // Find the playlist to add to. Since there are two playlist "tracks" for every track, we will just set to the first even one
-    int playlist_index = track_id * 2;
-    const string playlist_id = "playlist" + to_string(playlist_index);
-    XMLElement* track_playlist = FindPlaylistElement(playlist_id.c_str());
+    XMLElement* track_playlist = track_playlists[track_id];
 
     // Add blank entry
-    AddBlankElement(track_playlist, length);
+    XMLElement* blank = AddBlankElement(track_playlist, length);
 
     // Create TrackEntry
     TrackEntry entry;
     entry.entry_type = EntryType::BLANK;
     entry.length = length;
     entry.start_offset = 0;
+    entry.element = blank;
 
     // Set internal data
     track_lengths[track_id] += length;
-    track_entries[track_id].push_back(entry);
+    track_entries[track_id].PushBack(entry);
 
-    return track_entries[track_id].size() - 1;
+    return track_entries[track_id].Size() - 1;
 }
 
 TrackEntryId KdenliveFile::AddClipToTrack(const TrackId track_id, const ClipId clip_id, const float clip_length, const float clip_start_offset){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddClipToTrack");
+
     // Find the playlist to add to. Since there are two playlist "tracks" for every track, we will just set to the first even one
-    int playlist_index = track_id * 2;
-    const string playlist_id = "playlist" + to_string(playlist_index);
-    XMLElement* track_playlist = FindPlaylistElement(playlist_id.c_str());
+    XMLElement* track_playlist = track_playlists[track_id];
 
     // Add entry
     string chain_str = "chain" + to_string(clip_id);
-    AddEntryElement(track_playlist, clip_start_offset, clip_length + clip_start_offset, chain_str.c_str());
+    XMLElement* entry_element = AddEntryElement(track_playlist, clip_start_offset, clip_length + clip_start_offset, chain_str.c_str());
+
+    // Create TrackEntry
+    TrackEntry entry;
+    entry.entry_type = EntryType::CLIP;
+    entry.length = clip_length;
+    entry.start_offset = clip_start_offset;
+    entry.element = entry_element;
+
+    // Set internal data
+    track_lengths[track_id] += clip_length;
+    track_entries[track_id].PushBack(entry);
+
+    return  track_entries[track_id].Size() - 1;
+}
+
+TrackEntryId KdenliveFile::AddSequenceToTrack(const TrackId track_id, const SequenceId sequence_id, const float length, const float start_offset){
+    XMLElement* track_playlist = track_playlists[track_id];
+    XMLElement* sequence = sequence_tractors[sequence_id];
+
+    // The sequence lasts as long as its longest track
+    float sequence_length = 0;
+    for(TrackId i = 0; i < track_count; i++){
+        if(track_sequences[i] == sequence_id)
+            sequence_length = max(sequence_length, track_lengths[i]);
+    }
+    const string out_str = convertToOutTimestamp(sequence_length, GetFramerate());
+    sequence->SetAttribute("out", out_str.c_str());
+
+    // Add entry
+    XMLElement* entry_element = AddEntryElement(track_playlist, start_offset, length + start_offset, sequence->Attribute("id"));
 
     // Create TrackEntry
+    TrackEntry entry;
+    entry.entry_type = EntryType::CLIP;
+    entry.length = length;
+    entry.start_offset = start_offset;
+    entry.element = entry_element;
+
+    // Set internal data
+    track_lengths[track_id] += length;
+    track_entries[track_id].PushBack(entry);
+
+    return track_entries[track_id].Size() - 1;
+}
+
+TrackEntryId KdenliveFile::InsertClipIntoTrack(const TrackId track_id, const ClipId clip_id, const float time_stamp, const float clip_length, const float clip_start_offset){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::InsertClipIntoTrack");
+
+    // Past the end of the track, the clip is added as usual
+    if(time_stamp >= track_lengths[track_id] - GAP_TOLERANCE){
+        const float blank_length = time_stamp - track_lengths[track_id];
+        if(blank_length > GAP_TOLERANCE)
+            AddBlankToTrack(track_id, blank_length);
+        return AddClipToTrack(track_id, clip_id, clip_length, clip_start_offset);
+    }
+
+    const TrackEntryId gap_id = FindTrackGap(track_id, time_stamp, clip_length);
+    if(gap_id < 0)
+        return -1;
+    TrackIndex &entries = track_entries[track_id];
+    TrackEntry gap = entries.At(gap_id);
+    XMLElement* blank_element = gap.element;
+    const float gap_start = entries.GetStartTime(gap_id);
+    const float gap_end = gap_start + gap.length;
+
+    // Clips that nearly line up with the start of the gap are moved to it, so no tiny blank is left before them
+    const float clip_time = (time_stamp - gap_start > GAP_TOLERANCE) ? time_stamp : gap_start;
+    const float blank_before = clip_time - gap_start;
+    const float blank_after = gap_end - (clip_time + clip_length);
+
+    // The clip goes right after the blank, which keeps the space before the clip or is removed
+    const string chain_str = "chain" + to_string(clip_id);
+    XMLElement* entry_element = CreateEntryElement(clip_start_offset, clip_length + clip_start_offset, chain_str.c_str());
+    track_playlists[track_id]->InsertAfterChild(blank_element, entry_element);
+
+    TrackEntry entry;
+    entry.entry_type = EntryType::CLIP;
+    entry.length = clip_length;
+    entry.start_offset = clip_start_offset;
+    entry.element = entry_element;
+
+    TrackEntryId entry_id = gap_id;
+    if(blank_before > 0){
+        const string length_str = convertToTimestamp(blank_before);
+        blank_element->SetAttribute("length", length_str.c_str());
+        gap.length = blank_before;
+        entries.Set(gap_id, gap);
+        entries.Insert(gap_id + 1, entry);
+        entry_id++;
+    }
+    else{
+        track_playlists[track_id]->DeleteChild(blank_element);
+        entries.Set(gap_id, entry);
+    }
+    if(blank_after > GAP_TOLERANCE){
+        XMLElement* after_element = CreateBlankElement(blank_after);
+        track_playlists[track_id]->InsertAfterChild(entry_element, after_element);
+        entries.Insert(entry_id + 1, {EntryType::BLANK, blank_after, 0, after_element});
+    }
+
+    return entry_id;
+}
+
+int KdenliveFile::AddClipToMixPlaylist(const TrackId track_id, const ClipId clip_id, const float time_stamp, const float clip_length, const float clip_start_offset){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddClipToMixPlaylist");
+
+    XMLElement* mix_playlist = mix_playlists[track_id];
+    const float blank_length = time_stamp - mix_playlist_lengths[track_id];
+    if(blank_length < -GAP_TOLERANCE)
+        return -1;
+
+    // Fill the space between the last clip and this one
+    if(blank_length > GAP_TOLERANCE){
+        AddBlankElement(mix_playlist, blank_length);
+        mix_playlist_lengths[track_id] += blank_length;
+    }
+
+    const string chain_str = "chain" + to_string(clip_id);
+    XMLElement* entry_element = AddEntryElement(mix_playlist, clip_start_offset, clip_length + clip_start_offset, chain_str.c_str());
+
+    TrackEntry entry;
+    entry.entry_type = EntryType::CLIP;
+    entry.length = clip_length;
+    entry.start_offset = clip_start_offset;
+    entry.element = entry_element;
+
+    mix_playlist_lengths[track_id] += clip_length;
+    mix_playlist_clips[track_id].push_back(entry);
+
+    return mix_playlist_clips[track_id].size() - 1;
+}
+
+void KdenliveFile::AddMixTransition(const TrackId track_id, const float time_stamp, const float length, const bool is_reversed){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddMixTransition");
+
+    // The mix goes from the first playlist to the second, unless it is reversed
+    XMLElement* transition = CreateTransitionElement(track_types[track_id], 0, 1, time_stamp, length, is_reversed);
+    AddPropertyElement(transition, "reverse", is_reversed ? "1" : "0");
+    // Kdenlive keeps where the clips were cut within the mix, in frames, which is in the middle of the overlap
+    const int mix_cut = static_cast<int>(length / 2 * GetFramerate());
+    AddPropertyElement(transition, "kdenlive:mixcut", to_string(mix_cut).c_str());
+
+    track_tractors[track_id]->InsertEndChild(transition);
+    track_has_transitions[track_id] = true;
+}
+
+void KdenliveFile::AddCrossfade(const TrackId from_track_id, const TrackId to_track_id, const float time_stamp, const float length){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddCrossfade");
+
+    const SequenceId sequence_id = track_sequences[from_track_id];
+    if(track_sequences[to_track_id] != sequence_id  ||  track_types[to_track_id] != track_types[from_track_id]){
+        cerr << "Crossfade between tracks " << from_track_id << " and " << to_track_id << " must be between tracks of the same type and sequence";
+        return;
+    }
+
+    // Transitions go from the lower track to the higher one, so a crossfade down a track is reversed
+    const bool is_reversed = track_positions[from_track_id] > track_positions[to_track_id];
+    XMLElement* transition = CreateTransitionElement(track_types[from_track_id], min(track_positions[from_track_id], track_positions[to_track_id]),
+                                                     max(track_positions[from_track_id], track_positions[to_track_id]), time_stamp, length, is_reversed);
+    if(track_types[from_track_id] == TrackType::VIDEO)
+        AddPropertyElement(transition, "reverse", is_reversed ? "1" : "0");
+
+    sequence_tractors[sequence_id]->InsertEndChild(transition);
+    track_has_transitions[from_track_id] = true;
+    track_has_transitions[to_track_id] = true;
+}
+
+TrackEntryId KdenliveFile::RippleInsertClip(const TrackId track_id, const TrackEntryId entry_id, const ClipId clip_id, const float clip_length, const float clip_start_offset){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::RippleInsertClip");
+
+    TrackIndex &entries = track_entries[track_id];
+    if(entry_id < 0  ||  entry_id >= static_cast<TrackEntryId>(entries.Size()))
+        return AddClipToTrack(track_id, clip_id, clip_length, clip_start_offset);
+    if(!IsTrackRippleable(track_id))
+        return -1;
+
+    // Put the clip in front of the entry in the playlist, which moves everything after it
+    XMLElement* track_playlist = track_playlists[track_id];
+    XMLNode* previous_node = entries.At(entry_id).element->PreviousSibling();
+    const string chain_str = "chain" + to_string(clip_id);
+    XMLElement* entry_element = CreateEntryElement(clip_start_offset, clip_length + clip_start_offset, chain_str.c_str());
+    if(previous_node != nullptr)
+        track_playlist->InsertAfterChild(previous_node, entry_element);
+    else
+        track_playlist->InsertFirstChild(entry_element);
+
     TrackEntry entry;
     entry.entry_type = EntryType::CLIP;
     entry.length = clip_length;
     entry.start_offset = clip_start_offset;
+    entry.element = entry_element;
 
     // Set internal data
     track_lengths[track_id] += clip_length;
-    track_entries[track_id].push_back(entry);
+    entries.Insert(entry_id, entry);
 
-    return  track_entries[track_id].size() - 1;
+    return entry_id;
+}
+
+void KdenliveFile::RemoveEntry(const TrackId track_id, const TrackEntryId entry_id, const bool is_rippled){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::RemoveEntry");
+
+    TrackIndex &entries = track_entries[track_id];
+    if(entry_id < 0  ||  entry_id >= static_cast<TrackEntryId>(entries.Size()))
+        return;
+
+    const TrackEntry entry = entries.At(entry_id);
+    XMLElement* track_playlist = track_playlists[track_id];
+
+    if(is_rippled){
+        if(!IsTrackRippleable(track_id))
+            return;
+        track_playlist->DeleteChild(entry.element);
+        track_lengths[track_id] -= entry.length;
+        entries.Erase(entry_id);
+        return;
+    }
+
+    // Leave a blank in its place, so the rest of the track doesn't move
+    if(entry.entry_type == EntryType::BLANK)
+        return;
+    XMLElement* blank_element = CreateBlankElement(entry.length);
+    track_playlist->InsertAfterChild(entry.element, blank_element);
+    track_playlist->DeleteChild(entry.element);
+    entries.Set(entry_id, {EntryType::BLANK, entry.length, 0, blank_element});
 }
 
 void KdenliveFile::FadeClip(const TrackId track_id, TrackEntryId entry_id, const float fade_in_time, const float fade_out_time){
+    KDENCODE_TRACE_SCOPE("KdenliveFile::FadeClip");
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::FadeClip");
+
     // Get this TrackEntry
-    const TrackEntry this_entry = track_entries[track_id][entry_id];
+    const TrackEntry this_entry = track_entries[track_id].At(entry_id);
 
     // Don't allow a filter to be applied to Blank entries
     if(this_entry.entry_type == EntryType::BLANK)
         return;
 
     // Get the entry in the doc
-    const int playlist_index = track_id*2;
-    const string playlist_id = "playlist" + to_string(playlist_index);
-    XMLElement* entry = FindPlaylistEntry(playlist_id.c_str(), entry_id);
-    
+    XMLElement* entry = FindPlaylistEntry(track_id, entry_id);
 
-    // Fade in
-    if(fade_in_time > 0){
-        const string filter_id = "filter" + to_string(filter_count);
-        XMLElement* filter = CreateFilterElement(filter_id.c_str(), this_entry.start_offset, this_entry.start_offset + fade_in_time);
-        AddPropertyElement(filter, "start", "1");
-        AddPropertyElement(filter, "level", "1");
-        AddPropertyElement(filter, "mlt_service", "brightness");
-        AddPropertyElement(filter, "kdenlive_id", "fade_from_black");
-        AddPropertyElement(filter, "alpha", "0=0;-1=1");
-        entry->InsertEndChild(filter);
+    AddFadeFilters(track_id, entry, this_entry, fade_in_time, fade_out_time);
+}
+
+void KdenliveFile::FadeMixClip(const TrackId track_id, const int mix_clip_index, const float fade_in_time, const float fade_out_time){
+    KDENCODE_TRACE_SCOPE("KdenliveFile::FadeMixClip");
+
+    const TrackEntry &this_entry = mix_playlist_clips[track_id][mix_clip_index];
+    AddFadeFilters(track_id, this_entry.element, this_entry, fade_in_time, fade_out_time);
+}
+
+void KdenliveFile::SetEntryVolume(const TrackId track_id, const TrackEntryId entry_id, const float volume){
+    const VolumeKeyframe keyframe = { 0, volume };
+    const TrackEntry this_entry = track_entries[track_id].At(entry_id);
+    if(this_entry.entry_type == EntryType::BLANK)
+        return;
 
-        filter_count++;
+    AddVolumeFilter(this_entry.element, this_entry, &keyframe, 1);
+}
+
+void KdenliveFile::SetEntryVolume(const TrackId track_id, const TrackEntryId entry_id, const vector<VolumeKeyframe> &keyframes){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::SetEntryVolume");
+
+    const TrackEntry this_entry = track_entries[track_id].At(entry_id);
+    if(this_entry.entry_type == EntryType::BLANK  ||  keyframes.empty())
+        return;
+
+    AddVolumeFilter(this_entry.element, this_entry, keyframes.data(), keyframes.size());
+}
+
+void KdenliveFile::SetMixClipVolume(const TrackId track_id, const int mix_clip_index, const vector<VolumeKeyframe> &keyframes){
+    const TrackEntry &this_entry = mix_playlist_clips[track_id][mix_clip_index];
+    if(keyframes.empty())
+        return;
+
+    AddVolumeFilter(this_entry.element, this_entry, keyframes.data(), keyframes.size());
+}
+
+void KdenliveFile::SetTrackVolume(const TrackId track_id, const float volume){
+    XMLElement* tractor = track_tractors[track_id];
+    if(track_volume_filters[track_id] != nullptr){
+        tractor->DeleteChild(track_volume_filters[track_id]);
+        track_volume_filters[track_id] = nullptr;
     }
-    // Fade out
-    if(fade_out_time > 0){
-        const string filter_id = "filter" + to_string(filter_count);
-        XMLElement* filter = CreateFilterElement(filter_id.c_str(), this_entry.start_offset + this_entry.length - fade_out_time, this_entry.start_offset + this_entry.length);
-        AddPropertyElement(filter, "start", "1");
-        AddPropertyElement(filter, "level", "1");
-        AddPropertyElement(filter, "mlt_service", "brightness");
-        AddPropertyElement(filter, "kdenlive_id", "fade_to_black");
-        AddPropertyElement(filter, "alpha", "0=1;-1=0");
-        entry->InsertEndChild(filter);
+    if(volume == 0)
+        return;
+
+    // Track filters apply to the whole track, so they have no range
+    const VolumeKeyframe keyframe = { 0, volume };
+    XMLElement* filter = CreateVolumeFilterElement(&keyframe, 1);
+    const string filter_id = "filter" + to_string(filter_count);
+    filter->SetAttribute("id", filter_id.c_str());
+    tractor->InsertEndChild(filter);
+    track_volume_filters[track_id] = filter;
+
+    filter_count++;
+}
+
+void KdenliveFile::AddGuides(const Marker* guides, const size_t guide_count){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddGuides");
+
+    AddMarkersToProperty(timeline_tractor, GUIDES_PROPERTY_NAME, guides_writer, guides, guide_count);
+}
+
+void KdenliveFile::AddGuides(const vector<Marker> &guides){
+    AddGuides(guides.data(), guides.size());
+}
+
+void KdenliveFile::AddClipMarkers(const ClipId clip_id, const Marker* markers, const size_t marker_count){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::AddClipMarkers");
 
-        filter_count++;
+    // Every clip shares the writer, so the markers of each are read back from its property
+    json_writer.Clear();
+    AddMarkersToProperty(bin_chains[clip_id], "kdenlive:markers", json_writer, markers, marker_count);
+}
+
+void KdenliveFile::AddClipMarkers(const ClipId clip_id, const vector<Marker> &markers){
+    AddClipMarkers(clip_id, markers.data(), markers.size());
+}
+
+void KdenliveFile::TruncateTrack(const TrackId track_id, const TrackEntryId entry_id){
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::TruncateTrack");
+
+    TrackIndex &entries = track_entries[track_id];
+    if(entry_id < 0  ||  entry_id >= static_cast<TrackEntryId>(entries.Size()))
+        return;
+
+    // Delete blanks and entries from the end of the playlist, leaving any properties of the playlist
+    XMLElement* track_playlist = track_playlists[track_id];
+    int remove_count = entries.Size() - entry_id;
+    XMLElement* ptr = track_playlist->LastChildElement();
+    while(ptr != nullptr  &&  remove_count > 0){
+        XMLElement* cur_ptr = ptr;
+        ptr = ptr->PreviousSiblingElement();
+
+        if( strcmp(cur_ptr->Name(), "entry") == 0  ||  strcmp(cur_ptr->Name(), "blank") == 0 ){
+            track_playlist->DeleteChild(cur_ptr);
+            remove_count--;
+        }
     }
-    
 
-    
+    // Sum the remaining lengths in the order they were added, so the length is the same as if they were the only ones added
+    entries.Truncate(entry_id);
+    track_lengths[track_id] = entries.SumLengths();
+}
+
+void KdenliveFile::RenumberFilters(const vector<TrackId> &clip_track_order){
+    // The next clip entry of each track
+    vector<XMLElement*> next_entries(track_count);
+    for(TrackId track_id = 0; track_id < track_count; track_id++)
+        next_entries[track_id] = track_playlists[track_id]->FirstChildElement("entry");
+
+    filter_count = 0;
+    for(const TrackId track_id : clip_track_order){
+        XMLElement* entry = next_entries[track_id];
+        if(entry == nullptr)
+            continue;
+
+        for(XMLElement* filter = entry->FirstChildElement("filter"); filter != nullptr; filter = filter->NextSiblingElement("filter")){
+            const string filter_id = "filter" + to_string(filter_count);
+            filter->SetAttribute("id", filter_id.c_str());
+            filter_count++;
+        }
+
+        next_entries[track_id] = entry->NextSiblingElement("entry");
+    }
 }
 
 
@@ -287,7 +756,64 @@ float KdenliveFile::GetTrackLength(const TrackId track_id){
     return track_lengths[track_id];
 }
 
+bool KdenliveFile::IsTrackFree(const TrackId track_id, const float time_stamp, const float length) const{
+    if(time_stamp >= track_lengths[track_id] - GAP_TOLERANCE)
+        return true;
+
+    return FindTrackGap(track_id, time_stamp, length) >= 0;
+}
+
+int KdenliveFile::GetEntryCount(const TrackId track_id) const{
+    return track_entries[track_id].Size();
+}
+
+TrackEntryId KdenliveFile::FindEntryAt(const TrackId track_id, const float time_stamp) const{
+    const TrackIndex &entries = track_entries[track_id];
+    const size_t entry_index = entries.FindIndexAt(time_stamp);
+
+    return (entry_index < entries.Size()) ? static_cast<TrackEntryId>(entry_index) : -1;
+}
+
+float KdenliveFile::GetEntryTime(const TrackId track_id, const TrackEntryId entry_id) const{
+    return track_entries[track_id].GetStartTime(entry_id);
+}
+
+int KdenliveFile::GetTrackCount() const{
+    return track_count;
+}
+
+KdenliveFile::TrackType KdenliveFile::GetTrackType(const TrackId track_id) const{
+    return track_types[track_id];
+}
+
+int KdenliveFile::GetFilterCount() const{
+    return filter_count;
+}
+
+long long KdenliveFile::CountNodes() const{
+    // Walk the document depth first, without recursion
+    long long node_count = 0;
+    const XMLNode* ptr = xml_doc.FirstChild();
+    while(ptr != nullptr){
+        node_count++;
+
+        if(ptr->FirstChild() != nullptr){
+            ptr = ptr->FirstChild();
+            continue;
+        }
+        while(ptr != nullptr  &&  ptr->NextSibling() == nullptr)
+            ptr = ptr->Parent() != &xml_doc ? ptr->Parent() : nullptr;
+        if(ptr != nullptr)
+            ptr = ptr->NextSibling();
+    }
+
+    return node_count;
+}
+
 string KdenliveFile::ToString() const{
+    KDENCODE_TRACE_SCOPE("KdenliveFile::ToString");
+    KDENCODE_LATENCY_SCOPE("KdenliveFile::ToString");
+
     XMLPrinter printer;
     xml_doc.Print(&printer);
 
@@ -296,6 +822,8 @@ string KdenliveFile::ToString() const{
 }
 
 void KdenliveFile::SaveToFile(const string &file_name, const string &output_filepath) const{
+    KDENCODE_TRACE_SCOPE("KdenliveFile::SaveToFile");
+
     ofstream output;
 
     if(output_filepath != "")
@@ -326,11 +854,11 @@ XMLElement* KdenliveFile::AddPropertyElement(XMLElement* element_to_add_to, cons
 
 XMLElement* KdenliveFile::CreateEntryElement(const float in, const float out, const char* producer){
     XMLElement* entry = xml_doc.NewElement("entry");
-    const char* in_str = convertToTimestamp(in).c_str();
-    const char* out_str = convertToTimestamp(out).c_str();
+    const string in_str = convertToTimestamp(in);
+    const string out_str = convertToOutTimestamp(out, GetFramerate());
 
-    entry->SetAttribute("in", in_str);
-    entry->SetAttribute("out", out_str);
+    entry->SetAttribute("in", in_str.c_str());
+    entry->SetAttribute("out", out_str.c_str());
     entry->SetAttribute("producer", producer);
 
     return entry;
@@ -373,12 +901,12 @@ XMLElement* KdenliveFile::AddTrackElement(XMLElement* element_to_add_to, const c
 
 XMLElement* KdenliveFile::CreateFilterElement(const char* id, const float in, const float out){
     XMLElement* filter = xml_doc.NewElement("filter");
-    const char* in_str = convertToTimestamp(in).c_str();
-    const char* out_str = convertToTimestamp(out).c_str();
+    const string in_str = convertToTimestamp(in);
+    const string out_str = convertToOutTimestamp(out, GetFramerate());
 
     filter->SetAttribute("id", id);
-    filter->SetAttribute("in", in_str);
-    filter->SetAttribute("out", out_str);
+    filter->SetAttribute("in", in_str.c_str());
+    filter->SetAttribute("out", out_str.c_str());
 
     return filter;
 }
@@ -452,6 +980,10 @@ void KdenliveFile::AddElementToTopOfRoot(XMLElement* element){
     if(last_added_root_element == main_producer){
         last_added_root_element = element;
     }
+    // Sequences use the clips, so they must come after them too
+    if(last_added_sequence_element == main_producer){
+        last_added_sequence_element = element;
+    }
 
     // Add after the main_producer
     root->InsertAfterChild(main_producer, element);
@@ -463,6 +995,50 @@ void KdenliveFile::AddElementToRoot(XMLElement* element){
     last_added_root_element = element;
 }
 
+void KdenliveFile::AddElementToSequence(const SequenceId sequence_id, XMLElement* element){
+    if(sequence_id == MAIN_SEQUENCE){
+        AddElementToRoot(element);
+        return;
+    }
+
+    // The tracks of a sequence must be defined before the sequence itself
+    XMLElement* sequence = sequence_tractors[sequence_id];
+    root->InsertAfterChild(sequence->PreviousSibling(), element);
+}
+
+void KdenliveFile::SetPropertyElement(XMLElement* element, const char* name, const char* value){
+    XMLElement* property = FindPropertyElement(element, name);
+
+    if(value == nullptr){
+        if(property != nullptr)
+            element->DeleteChild(property);
+    }
+    else if(property == nullptr){
+        // Add the property after the other properties, but before any entries or tracks
+        property = CreatePropertyElement(name, value);
+
+        XMLElement* last_property = element->LastChildElement("property");
+        if(last_property == nullptr)
+            element->InsertFirstChild(property);
+        else
+            element->InsertAfterChild(last_property, property);
+    }
+    else
+        property->SetText(value);
+}
+
+XMLElement* KdenliveFile::FindPropertyElement(XMLElement* element, const char* property_name) const{
+    XMLElement* ptr = element->FirstChildElement("property");
+    while(ptr != nullptr){
+        if( ptr->Attribute("name", property_name) )
+            break;
+
+        ptr = ptr->NextSiblingElement("property");
+    }
+
+    return ptr;
+}
+
 XMLElement* KdenliveFile::FindPlaylistElement(const char* playlist_id) const{
     XMLElement* ptr = root->FirstChildElement();
     while(ptr != nullptr){
@@ -489,37 +1065,184 @@ XMLElement* KdenliveFile::FindTractorElement(const char* tractor_id) const{
     return ptr;
 }
 
-XMLElement* KdenliveFile::FindPlaylistEntry(const char* playlist_id, const TrackEntryId entry_index){
-    // Find playlist
-    XMLElement* playlist = FindPlaylistElement(playlist_id);
-    
-    // Count through the entries of the playlist
-    XMLElement* ptr = playlist->FirstChildElement();
-    int c = 0;
-    while(ptr != nullptr){
-        if( strcmp(ptr->Name(), "entry") == 0  ||  strcmp(ptr->Name(), "blank") == 0){
-            c++;
+XMLElement* KdenliveFile::FindPlaylistEntry(const TrackId track_id, const TrackEntryId entry_index){
+    return track_entries[track_id].At(entry_index).element;
+}
+
+void KdenliveFile::AddFadeFilters(const TrackId track_id, XMLElement* entry_element, const TrackEntry &entry, const float fade_in_time, const float fade_out_time){
+    const bool is_audio = track_types[track_id] == TrackType::AUDIO;
+
+    // Fade in
+    if(fade_in_time > 0)
+        AddFadeFilter(entry_element, is_audio, true, entry.start_offset, entry.start_offset + fade_in_time);
+    // Fade out
+    if(fade_out_time > 0)
+        AddFadeFilter(entry_element, is_audio, false, entry.start_offset + entry.length - fade_out_time, entry.start_offset + entry.length);
+}
+
+void KdenliveFile::AddVolumeFilter(XMLElement* entry_element, const TrackEntry &entry, const VolumeKeyframe* keyframes, const size_t keyframe_count){
+    XMLElement* filter = CreateVolumeFilterElement(keyframes, keyframe_count);
+    const string filter_id = "filter" + to_string(filter_count);
+    const string in_str = convertToTimestamp(entry.start_offset);
+    const string out_str = convertToOutTimestamp(entry.start_offset + entry.length, GetFramerate());
+    filter->SetAttribute("id", filter_id.c_str());
+    filter->SetAttribute("in", in_str.c_str());
+    filter->SetAttribute("out", out_str.c_str());
+    entry_element->InsertEndChild(filter);
+
+    filter_count++;
+}
+
+XMLElement* KdenliveFile::CreateVolumeFilterElement(const VolumeKeyframe* keyframes, const size_t keyframe_count){
+    // Keyframes are counted in frames from the start of the filter
+    const float framerate = GetFramerate();
+    keyframe_writer.Clear();
+    for(size_t i = 0; i < keyframe_count; i++)
+        keyframe_writer.AddKeyframe( static_cast<int>(lround(keyframes[i].time_stamp * framerate)), keyframes[i].volume );
+
+    XMLElement* filter = xml_doc.NewElement("filter");
+    AddPropertyElement(filter, "window", "75");
+    AddPropertyElement(filter, "max_gain", "20dB");
+    AddPropertyElement(filter, "mlt_service", "volume");
+    AddPropertyElement(filter, "kdenlive_id", "volume");
+    AddPropertyElement(filter, "level", keyframe_writer.CStr());
+
+    return filter;
+}
+
+// Creates a dissolve between video tracks, or a crossfade between audio tracks, from a_track to b_track of the tractor it is added to
+XMLElement* KdenliveFile::CreateTransitionElement(const TrackType track_type, const int a_track, const int b_track, const float time_stamp, const float length,
+                                                  const bool is_reversed){
+    const string transition_id = "transition" + to_string(transition_count);
+    const string in_str = convertToTimestamp(time_stamp);
+    const string out_str = convertToOutTimestamp(time_stamp + length, GetFramerate());
+    XMLElement* transition = xml_doc.NewElement("transition");
+    transition->SetAttribute("id", transition_id.c_str());
+    transition->SetAttribute("in", in_str.c_str());
+    transition->SetAttribute("out", out_str.c_str());
+    transition_count++;
+
+    AddPropertyElement(transition, "a_track", to_string(a_track).c_str());
+    AddPropertyElement(transition, "b_track", to_string(b_track).c_str());
+    if(track_type == TrackType::VIDEO){
+        // A luma transition without a resource is a plain dissolve
+        AddPropertyElement(transition, "mlt_service", "luma");
+        AddPropertyElement(transition, "kdenlive_id", "luma");
+        AddPropertyElement(transition, "resource", "");
+    }
+    else{
+        AddPropertyElement(transition, "mlt_service", "mix");
+        AddPropertyElement(transition, "kdenlive_id", "mix");
+        AddPropertyElement(transition, "start", is_reversed ? "1" : "0");
+        AddPropertyElement(transition, "end", is_reversed ? "0" : "1");
+        AddPropertyElement(transition, "accepts_blanks", "1");
+    }
+
+    return transition;
+}
 
-            if( c > entry_index)    break;
+// Continues the array the writer already holds for the property, or if it holds nothing, the array already in the property,
+// which the template has as an empty array
+void KdenliveFile::AddMarkersToProperty(XMLElement* element, const char* property_name, JsonWriter &writer, const Marker* markers, const size_t marker_count){
+    if(marker_count == 0)
+        return;
+
+    if(!writer.ReopenArray()){
+        const XMLElement* property = FindPropertyElement(element, property_name);
+        const char* property_text = (property != nullptr) ? property->GetText() : nullptr;
+        if(property_text != nullptr){
+            if(!writer.ReopenArray(property_text)){
+                cerr << "Markers can't be added to property '" << property_name << "', because it isn't a JSON array";
+                return;
+            }
         }
+        else{
+            writer.Clear();
+            writer.BeginArray();
+        }
+    }
 
-        ptr = ptr->NextSiblingElement();
+    // Kdenlive places markers on frames
+    const float framerate = GetFramerate();
+    for(size_t i = 0; i < marker_count; i++){
+        writer.BeginObject();
+        writer.AddKey("comment");
+        writer.AddString(markers[i].comment);
+        writer.AddKey("pos");
+        writer.AddInt( lround(markers[i].time_stamp * framerate) );
+        writer.AddKey("type");
+        writer.AddInt(markers[i].category);
+        writer.EndObject();
     }
-    
-    return ptr;
+    writer.EndArray();
+
+    SetPropertyElement(element, property_name, writer.CStr());
 }
 
-string KdenliveFile::FindDocUUID(){
-    // Check main bin for kdenlive:docproperties.uuid property
-    XMLElement* ptr = main_bin->FirstChildElement();
+void KdenliveFile::AddFadeFilter(XMLElement* entry_element, const bool is_audio, const bool is_fade_in, const float in, const float out){
+    const string filter_id = "filter" + to_string(filter_count);
+    XMLElement* filter = AddFilterElement(entry_element, filter_id.c_str(), in, out);
+
+    if(is_audio){
+        // Audio fades ramp the gain of the volume filter between silent and full volume
+        AddPropertyElement(filter, "window", "75");
+        AddPropertyElement(filter, "max_gain", "20dB");
+        AddPropertyElement(filter, "mlt_service", "volume");
+        AddPropertyElement(filter, "kdenlive_id", is_fade_in ? "fadein" : "fadeout");
+        AddPropertyElement(filter, "gain", is_fade_in ? "0" : "1");
+        AddPropertyElement(filter, "end", is_fade_in ? "1" : "0");
+    }
+    else{
+        AddPropertyElement(filter, "start", "1");
+        AddPropertyElement(filter, "level", "1");
+        AddPropertyElement(filter, "mlt_service", "brightness");
+        AddPropertyElement(filter, "kdenlive_id", is_fade_in ? "fade_from_black" : "fade_to_black");
+        AddPropertyElement(filter, "alpha", is_fade_in ? "0=0;-1=1" : "0=1;-1=0");
+    }
 
-    while(ptr != nullptr){
-        if( strcmp(ptr->Name(), "property") == 0  &&  ptr->Attribute("name", "kdenlive:docproperties.uuid") )
-            break;
-        
-        ptr = ptr->NextSiblingElement();
+    filter_count++;
+}
+
+TrackEntryId KdenliveFile::FindTrackGap(const TrackId track_id, const float time_stamp, const float length) const{
+    const TrackIndex &entries = track_entries[track_id];
+
+    // The entry playing at the start of the clip, which must be a blank that the clip ends within.
+    // A clip just before a blank may still fit, since clips may overlap a gap a little
+    TrackEntryId gap_id = FindEntryAt(track_id, time_stamp);
+    if(gap_id < 0)
+        return -1;
+    if(entries.At(gap_id).entry_type != EntryType::BLANK){
+        gap_id = FindEntryAt(track_id, time_stamp + GAP_TOLERANCE);
+        if(gap_id < 0  ||  entries.At(gap_id).entry_type != EntryType::BLANK)
+            return -1;
+    }
+
+    const float gap_start = entries.GetStartTime(gap_id);
+    const float clip_start = max(time_stamp, gap_start);
+    if(clip_start + length > gap_start + entries.At(gap_id).length + GAP_TOLERANCE)
+        return -1;
+
+    return gap_id;
+}
+
+bool KdenliveFile::IsTrackRippleable(const TrackId track_id) const{
+    // Mix clips and transitions are placed by time, so they would no longer line up with the clips they join
+    if(!mix_playlist_clips[track_id].empty()  ||  track_has_transitions[track_id]){
+        cerr << "Track " << track_id << " has mixes or crossfades, so its entries can't be rippled";
+        return false;
     }
 
+    return true;
+}
+
+float KdenliveFile::GetFramerate() const{
+    return profile->FloatAttribute("frame_rate_num") / profile->IntAttribute("frame_rate_den", 1);
+}
+
+string KdenliveFile::FindDocUUID(){
+    // Check main bin for kdenlive:docproperties.uuid property
+    XMLElement* ptr = FindPropertyElement(main_bin, "kdenlive:docproperties.uuid");
+
     if(ptr == nullptr)
         return "NULL_UUID";
 
@@ -6,6 +6,9 @@
 #include <string>
 #include <vector>
 #include "tinyxml2.h"
+#include "JsonWriter.h"
+#include "KeyframeWriter.h"
+#include "TrackIndex.h"
 
 
 // FILE MANAGEMENT
@@ -20,10 +23,30 @@ std::ofstream openOutputFile(const std::string &filePath);
 std::string readEntireFile(std::ifstream &input_file);
 
 
+// TIME FORMATTING
+/** Formats a time in seconds as the "HH:MM:SS.mmm" timestamp the file uses, cut to whole milliseconds
+ */
+std::string convertToTimestamp(float seconds);
+
+
 // External data types
 typedef int ClipId;
 typedef int TrackId;
 typedef int TrackEntryId;
+typedef int SequenceId;
+
+// The volume of an entry at a point in time, which the volume is animated between
+struct VolumeKeyframe{
+    float time_stamp;       // Time from the start of the entry, in seconds
+    float volume;           // Gain, in dB, where 0 leaves the volume unchanged
+};
+
+// A guide on the timeline, or a marker on a clip, which Kdenlive shows with its comment in the color of its category
+struct Marker{
+    float time_stamp;       // Time from the start of the timeline, or from the start of the clip's media, in seconds
+    std::string comment;
+    int category = 0;       // Index of one of the guide categories of the document
+};
 
 
 // Wrapper class for XMLDocument, specifically for .kdenlive files
@@ -34,18 +57,13 @@ class KdenliveFile{
         AUDIO,
         VIDEO,
     };
+    // The SequenceId of the main timeline
+    static const SequenceId MAIN_SEQUENCE = 0;
 
     private:
     // Internal data types
-    enum EntryType{
-        CLIP,
-        BLANK,
-    };
-    struct TrackEntry{
-        EntryType entry_type;
-        float length;
-        float start_offset;
-    };
+    typedef TrackIndex::EntryType EntryType;
+    typedef TrackIndex::Entry TrackEntry;
 
 
     public:
@@ -65,10 +83,43 @@ class KdenliveFile{
      *  @param length specifies the length, in pixels, of the video
      */
     void SetProfile(const int framerate, const int width, const int height);
+    /** Sets the value of a property of the main bin, adding the property if it doesn't exist yet.
+     *  Kdenlive keeps the document settings here, as properties named "kdenlive:docproperties.<setting>".
+     *  Passing a null value removes the property.
+     */
+    void SetBinProperty(const char* name, const char* value);
+    /** Sets the value of a property of the timeline, adding the property if it doesn't exist yet.
+     *  Kdenlive keeps the settings of each timeline sequence here, as properties named "kdenlive:sequenceproperties.<setting>".
+     *  Passing a null value removes the property.
+     */
+    void SetTimelineProperty(const char* name, const char* value);
+    /** Limits the rendered part of the timeline to the given frames, by setting the in and out points of the final tractor.
+     *  Both frames are included, so consecutive zones should start one frame after the previous zone's out_frame.
+     */
+    void SetRenderZone(const int in_frame, const int out_frame);
+    /** Adds an avformat consumer that renders the file to target, or changes the target of the one already added.
+     *  melt renders a file with a consumer on its own, without needing any other arguments.
+     *  The format and codecs are chosen by avformat from the extension of target.
+     */
+    void SetRenderTarget(const std::string &target);
+    /** Links a proxy file to a clip in the bin, which Kdenlive then plays in place of the clip's own file.
+     *  Proxies are only used if they are enabled in the document settings, with the "kdenlive:docproperties.enableproxy" bin property.
+     *  Passing an empty path removes the proxy from the clip.
+     */
+    void SetClipProxy(const ClipId clip_id, const std::string &proxy_path);
     /** Adds a new track to the file, either video or audio
      *  Returns a TrackId, which is used to add clips to the new track.
+     *  The track is added to the main timeline, unless the SequenceId of another sequence is given.
+     */
+    TrackId AddTrack(const TrackType track_type, const SequenceId sequence_id = MAIN_SEQUENCE);
+    /** Adds a new, empty timeline sequence to the file and the project bin.
+     *  Tracks can be added to the sequence with AddTrack(), and it can be placed on other tracks with AddSequenceToTrack(),
+     *  so that its contents are only written once however many times it is placed.
+     *  Returns a SequenceId, which is used to add tracks to the sequence and to place it.
+     * 
+     *  NOTE: A sequence that is placed inside another sequence must be added before the sequence it is placed in.
      */
-    TrackId AddTrack(const TrackType track_type);
+    SequenceId AddSequence(const std::string &name);
     /** Adds a clip to the project bin.
      *  Returns a ClipId, which is used to add the new clip to a track.
      *  This must be called before a clip can be added using AddClipToTrack().
@@ -82,19 +133,121 @@ class KdenliveFile{
      *  Returns a TrackEntryId, which is used to modify the entry later, if needed.
      */
     TrackEntryId AddClipToTrack(const TrackId track_id, const ClipId clip_id, const float clip_length, const float clip_start_offset = 0);
-    /** Adds a fade filter to the given entry, on the given track.
+    /** Adds a sequence with the given length and starting offset to the end of the track, as a single entry.
+     *  Returns a TrackEntryId, which is used to modify the entry later, if needed.
+     */
+    TrackEntryId AddSequenceToTrack(const TrackId track_id, const SequenceId sequence_id, const float length, const float start_offset = 0);
+    /** Adds a clip from the bin at the given time on the track, either inside a blank or after the end of the track.
+     *  A blank the clip is placed inside is split around it, and entries after it keep their time, but their TrackEntryId increases.
+     *  Returns the TrackEntryId of the clip, or -1 if the clip would overlap another entry.
+     */
+    TrackEntryId InsertClipIntoTrack(const TrackId track_id, const ClipId clip_id, const float time_stamp, const float clip_length, const float clip_start_offset = 0);
+    /** Adds a clip from the bin at the given time to the second playlist of the track, after every clip already in it.
+     *  Kdenlive plays both playlists of a track, and uses the second one for clips that overlap the clips of the first, so the two can be mixed.
+     *  Returns the index of the clip among the clips of the second playlist, or -1 if it would overlap the last of them.
+     */
+    int AddClipToMixPlaylist(const TrackId track_id, const ClipId clip_id, const float time_stamp, const float clip_length, const float clip_start_offset = 0);
+    /** Adds a mix transition between the two playlists of the track, over the given range of time.
+     *  Video tracks dissolve between the clips, and audio tracks crossfade between them.
      *  
-     *  NOTE: This does not currently affect clips placed on an audio track.
+     *  @param is_reversed specifies that the mix goes from the clip in the second playlist to the clip in the first, rather than the other way.
+     */
+    void AddMixTransition(const TrackId track_id, const float time_stamp, const float length, const bool is_reversed);
+    /** Adds a crossfade transition from the clip on one track to the clip on another, over the given range of time.
+     *  Video tracks dissolve from one clip to the other, and audio tracks crossfade between them.
+     *  Both tracks must be of the same type and in the same sequence.
+     */
+    void AddCrossfade(const TrackId from_track_id, const TrackId to_track_id, const float time_stamp, const float length);
+    /** Adds a clip from the bin before the given entry, and moves that entry and every entry after it back by the length of the clip.
+     *  Passing the number of entries on the track adds the clip to the end of the track.
+     *  Returns the TrackEntryId of the clip. The TrackEntryId of every entry after it increases by one.
+     * 
+     *  NOTE: Tracks with clips in their second playlist, or with mix or crossfade transitions, can't be rippled, since those stay where they are.
+     *  Inserting into them returns -1, unless the clip is added to the end of the track.
+     */
+    TrackEntryId RippleInsertClip(const TrackId track_id, const TrackEntryId entry_id, const ClipId clip_id, const float clip_length, const float clip_start_offset = 0);
+    /** Removes the given entry, along with its filters, from the track.
+     *  If is_rippled is true, every entry after it moves forward by its length, and their TrackEntryId decreases by one.
+     *  Otherwise the entry is replaced by a blank of the same length, so nothing else moves.
+     *  NOTE: On tracks that can't be rippled, as with RippleInsertClip(), a rippled removal does nothing.
+     */
+    void RemoveEntry(const TrackId track_id, const TrackEntryId entry_id, const bool is_rippled = true);
+    /** Adds a fade filter to the given entry, on the given track.
+     *  Entries on video tracks fade from and to black, and entries on audio tracks fade their volume in and out.
      * 
      *  @param fade_in_time specifies how long the fade will last at the beginning of the entry.
      *  @param fade_out_time specifies how long the fade will last at the end of the entry.
      */
     void FadeClip(const TrackId track_id, const TrackEntryId entry_id, const float fade_in_time, const float fade_out_time);
+    /** Adds a fade filter to the given clip of the second playlist of the track, the same way as FadeClip().
+     */
+    void FadeMixClip(const TrackId track_id, const int mix_clip_index, const float fade_in_time, const float fade_out_time);
+    /** Adds a volume filter to the given entry, on the given track, which changes its volume by volume dB.
+     */
+    void SetEntryVolume(const TrackId track_id, const TrackEntryId entry_id, const float volume);
+    /** Adds a volume filter to the given entry, on the given track, which animates its volume between the keyframes.
+     *  The keyframes must be in order of time. Their times are rounded to the nearest frame.
+     */
+    void SetEntryVolume(const TrackId track_id, const TrackEntryId entry_id, const std::vector<VolumeKeyframe> &keyframes);
+    /** Adds a volume filter to the given clip of the second playlist of the track, the same way as SetEntryVolume().
+     */
+    void SetMixClipVolume(const TrackId track_id, const int mix_clip_index, const std::vector<VolumeKeyframe> &keyframes);
+    /** Changes the volume of everything on the track by volume dB, with a volume filter on the track itself.
+     *  Setting the volume again replaces the filter, and a volume of 0 removes it.
+     */
+    void SetTrackVolume(const TrackId track_id, const float volume);
+    /** Adds guides to the timeline, after any guides it already has.
+     *  The guides are written straight into the JSON text of the timeline's guides property, which is kept between calls,
+     *  so adding more guides later doesn't read back the ones already added. Adding them all at once is still faster,
+     *  since the property is set again on each call.
+     */
+    void AddGuides(const Marker* guides, const size_t guide_count);
+    void AddGuides(const std::vector<Marker> &guides);
+    /** Adds markers to a clip in the bin, after any markers it already has, the same way as AddGuides().
+     *  Markers belong to the clip in the bin, so they show on every entry of the clip.
+     */
+    void AddClipMarkers(const ClipId clip_id, const Marker* markers, const size_t marker_count);
+    void AddClipMarkers(const ClipId clip_id, const std::vector<Marker> &markers);
+    /** Removes the given entry, and every entry after it, from the track.
+     *  The track can then be added to again from that point, and the track itself is kept.
+     *  Passing an entry_id of 0 removes every entry from the track.
+     */
+    void TruncateTrack(const TrackId track_id, const TrackEntryId entry_id);
+    /** Renames every filter, so the ids are the same as if the clips had been added and faded in the given order.
+     *  This is needed after a track is truncated and added to again, since filter ids are numbered across the whole file.
+     * 
+     *  @param clip_track_order lists the track of each clip entry, in the order the clips would have been added.
+     */
+    void RenumberFilters(const std::vector<TrackId> &clip_track_order);
     
     // GETTERS
     /** Returns the length all entries on the track
      */
     float GetTrackLength(const TrackId track_id);
+    /** Returns whether nothing is placed on the track between the given time and the time after length, which may be past the end of the track.
+     */
+    bool IsTrackFree(const TrackId track_id, const float time_stamp, const float length) const;
+    /** Returns the number of entries, including blanks, on the track.
+     */
+    int GetEntryCount(const TrackId track_id) const;
+    /** Returns the TrackEntryId of the entry playing at the given time, or -1 if the time is past the end of the track.
+     */
+    TrackEntryId FindEntryAt(const TrackId track_id, const float time_stamp) const;
+    /** Returns the time the given entry starts at on its track.
+     */
+    float GetEntryTime(const TrackId track_id, const TrackEntryId entry_id) const;
+    /** Returns the number of tracks in the file.
+     */
+    int GetTrackCount() const;
+    /** Returns whether the track is a video or audio track.
+     */
+    TrackType GetTrackType(const TrackId track_id) const;
+    /** Returns the number of filters that have been added to the file.
+     */
+    int GetFilterCount() const;
+    /** Counts every node in the document. This walks the entire document, so it should not be called often.
+     */
+    long long CountNodes() const;
     /** Returns the file as a string, which can then be saved to a file.
      */
     std::string ToString() const;
@@ -125,10 +278,23 @@ class KdenliveFile{
 
     void AddElementToTopOfRoot(tinyxml2::XMLElement* element);
     void AddElementToRoot(tinyxml2::XMLElement* element);
+    void AddElementToSequence(const SequenceId sequence_id, tinyxml2::XMLElement* element);
 
+    void SetPropertyElement(tinyxml2::XMLElement* element, const char* name, const char* value);
+    tinyxml2::XMLElement* FindPropertyElement(tinyxml2::XMLElement* element, const char* property_name) const;
     tinyxml2::XMLElement* FindPlaylistElement(const char* playlist_id) const;
     tinyxml2::XMLElement* FindTractorElement(const char* tractor_id) const;
-    tinyxml2::XMLElement* FindPlaylistEntry(const char* playlist_id, const TrackEntryId entry_index);
+    tinyxml2::XMLElement* FindPlaylistEntry(const TrackId track_id, const TrackEntryId entry_index);
+    TrackEntryId FindTrackGap(const TrackId track_id, const float time_stamp, const float length) const;
+    bool IsTrackRippleable(const TrackId track_id) const;
+    float GetFramerate() const;
+    void AddFadeFilters(const TrackId track_id, tinyxml2::XMLElement* entry_element, const TrackEntry &entry, const float fade_in_time, const float fade_out_time);
+    void AddFadeFilter(tinyxml2::XMLElement* entry_element, const bool is_audio, const bool is_fade_in, const float in, const float out);
+    void AddVolumeFilter(tinyxml2::XMLElement* entry_element, const TrackEntry &entry, const VolumeKeyframe* keyframes, const size_t keyframe_count);
+    tinyxml2::XMLElement* CreateVolumeFilterElement(const VolumeKeyframe* keyframes, const size_t keyframe_count);
+    tinyxml2::XMLElement* CreateTransitionElement(const TrackType track_type, const int a_track, const int b_track, const float time_stamp, const float length,
+                                                  const bool is_reversed);
+    void AddMarkersToProperty(tinyxml2::XMLElement* element, const char* property_name, JsonWriter &writer, const Marker* markers, const size_t marker_count);
 
     std::string FindDocUUID();
 
@@ -143,13 +309,32 @@ class KdenliveFile{
     tinyxml2::XMLElement* timeline_tractor;
     tinyxml2::XMLElement* main_bin;
     tinyxml2::XMLElement* final_tractor;
+    tinyxml2::XMLElement* render_consumer;
     tinyxml2::XMLElement* last_added_root_element;
+    tinyxml2::XMLElement* last_added_sequence_element;     // Sequences are kept before the main timeline's tracks, which may place them
+    KeyframeWriter keyframe_writer;     // Reused by every animated property, so writing keyframes doesn't allocate
+    JsonWriter json_writer;             // Reused by every list of markers of a clip, so writing them doesn't allocate
+    JsonWriter guides_writer;           // Holds the guides property once guides are added, so more are added to the end without reading it back
     // Keeping track of important data
     int chain_count;
     int track_count;
     int filter_count;
+    int transition_count;
     std::vector<float> track_lengths;
-    std::vector<std::vector<TrackEntry>> track_entries;
+    std::vector<TrackIndex> track_entries;
+    std::vector<tinyxml2::XMLElement*> track_playlists;     // The playlist that entries are added to, for each track
+    std::vector<tinyxml2::XMLElement*> mix_playlists;       // The second playlist of each track, which clips that overlap are added to
+    std::vector<float> mix_playlist_lengths;
+    std::vector<std::vector<TrackEntry>> mix_playlist_clips;
+    std::vector<tinyxml2::XMLElement*> track_tractors;      // The tractor joining the two playlists of each track
+    std::vector<TrackType> track_types;
+    std::vector<tinyxml2::XMLElement*> track_volume_filters;   // The volume filter of each track, or null if its volume is unchanged
+    std::vector<int> track_positions;                       // Position of each track among the tracks of its sequence's tractor
+    std::vector<int> sequence_track_counts;                 // Number of tracks in each sequence's tractor, including the black track
+    std::vector<tinyxml2::XMLElement*> bin_chains;          // The chain of each clip in the bin, indexed by ClipId
+    std::vector<tinyxml2::XMLElement*> sequence_tractors;   // The tractor holding the tracks of each sequence, indexed by SequenceId
+    std::vector<SequenceId> track_sequences;                // The sequence each track belongs to, indexed by TrackId
+    std::vector<bool> track_has_transitions;                // Whether a mix or crossfade covers part of each track
 };
 
 
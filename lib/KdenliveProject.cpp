@@ -1,5 +1,22 @@
+#include <algorithm>
+#include <array>
 #include <filesystem>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
 #include "KdenliveProject.h"
+#include "MappedFile.h"
+#include "Trace.h"
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -7,6 +24,11 @@ using namespace tinyxml2;
 
 
 const char* DEFAULT_MEDIA_FORMAT = ".mp4";
+const int MANIFEST_COLUMN_COUNT = 7;
+const double MIN_BLANK_LENGTH = 0.00099;	// Blanks shorter than this are not added to tracks
+const char* PROJECT_HASH_PROPERTY = "kdencode:projecthash";
+const int PREVIEW_CHUNK_FRAME_COUNT = 25;	// Kdenlive's default length of a timeline preview chunk
+const char* PROJECT_HASH_VERSION = "KdenCode project hash 3";	// Change this whenever the generated file changes for the same project
 
 
 string findFilePath(const vector<string> &media_folder_paths, const string &file_name){
@@ -32,23 +54,545 @@ string findFilePath(const vector<string> &media_folder_paths, const string &file
 }
 
 
+// MANIFEST PARSING
+// A single field of a manifest row, pointing directly into the mapped file
+struct ManifestField{
+	const char* begin;
+	const char* end;
+};
+
+bool isManifestSpace(const char c, const char delimiter){
+	return (c == ' ' || c == '\t') && c != delimiter;
+}
+
+// Splits a line into at most max_fields fields without copying it, and returns how many were found
+int tokenizeManifestLine(const char* line_begin, const char* line_end, const char delimiter, ManifestField* fields, const int max_fields){
+	const char* ptr = line_begin;
+	int field_count = 0;
+
+	while(field_count < max_fields){
+		// Skip leading whitespace
+		while(ptr < line_end && isManifestSpace(*ptr, delimiter))
+			ptr++;
+
+		ManifestField &field = fields[field_count];
+		field_count++;
+
+		// Quoted fields end at the next quote, and may contain the delimiter
+		if(ptr < line_end && *ptr == '"'){
+			field.begin = ptr + 1;
+			const char* quote = static_cast<const char*>( memchr(field.begin, '"', line_end - field.begin) );
+			field.end = (quote != nullptr) ? quote : line_end;
+			ptr = field.end;
+		}
+		else{
+			field.begin = ptr;
+			field.end = nullptr;
+		}
+
+		// Find the end of the field
+		const char* next_delimiter = static_cast<const char*>( memchr(ptr, delimiter, line_end - ptr) );
+		if(field.end == nullptr){
+			field.end = (next_delimiter != nullptr) ? next_delimiter : line_end;
+			// Trim trailing whitespace
+			while(field.end > field.begin && isManifestSpace(field.end[-1], delimiter))
+				field.end--;
+		}
+
+		if(next_delimiter == nullptr)
+			break;
+		ptr = next_delimiter + 1;
+	}
+
+	return field_count;
+}
+
+// Parses the entire field as a float. Empty fields are given the default value
+bool parseManifestFloat(const ManifestField &field, float &value, const float default_value){
+	if(field.begin == field.end){
+		value = default_value;
+		return true;
+	}
+
+	const from_chars_result result = from_chars(field.begin, field.end, value);
+	return result.ec == errc() && result.ptr == field.end;
+}
+
+
+// PROJECT FILE LOADING
+// A clip found on a playlist while loading a .kdenlive file
+struct LoadedPlacement{
+	float time_stamp;
+	const string* name;
+	float length;
+	float start_offset;
+	float fade_in_time;
+	float fade_out_time;
+	bool is_audio;
+};
+
+// Converts an MLT time value, either a "HH:MM:SS.mmm" timestamp or a frame count, into seconds
+float convertFromTimestamp(const char* time_value, const float framerate){
+	if(time_value == nullptr)
+		return 0;
+
+	// Frame count
+	if(strchr(time_value, ':') == nullptr)
+		return strtof(time_value, nullptr) / framerate;
+
+	// Timestamp
+	float seconds = 0;
+	const char* ptr = time_value;
+	while(true){
+		char* part_end;
+		seconds = seconds * 60 + strtof(ptr, &part_end);
+
+		if(*part_end != ':')
+			break;
+		ptr = part_end + 1;
+	}
+
+	return seconds;
+}
+
+// Converts an MLT time value into a whole number of frames, so the milliseconds timestamps are cut to don't add up along a playlist
+long convertToFrames(const char* time_value, const float framerate){
+	return lround(convertFromTimestamp(time_value, framerate) * framerate);
+}
+
+// Returns the text of the property with the given name that is a direct child of the element, or nullptr
+const char* findPropertyText(const XMLElement* element, const char* property_name){
+	for(const XMLElement* ptr = element->FirstChildElement("property"); ptr != nullptr; ptr = ptr->NextSiblingElement("property")){
+		if( ptr->Attribute("name", property_name) ){
+			const char* text = ptr->GetText();
+			return (text != nullptr) ? text : "";
+		}
+	}
+
+	return nullptr;
+}
+
+bool isAudioElement(const XMLElement* element){
+	const char* audio_track = findPropertyText(element, "kdenlive:audio_track");
+	return audio_track != nullptr  &&  strcmp(audio_track, "1") == 0;
+}
+
+// Walks a playlist or tractor used as a track, and collects every clip placed on it
+void collectPlacements(const XMLElement* element, bool is_audio, const float framerate,
+						const unordered_map<string, const XMLElement*> &elements,
+						const unordered_map<string, string> &producer_names,
+						vector<LoadedPlacement> &placements){
+	is_audio = is_audio || isAudioElement(element);
+
+	// Tractors hold their playlists as tracks
+	if( strcmp(element->Name(), "tractor") == 0 ){
+		for(const XMLElement* track = element->FirstChildElement("track"); track != nullptr; track = track->NextSiblingElement("track")){
+			const char* producer = track->Attribute("producer");
+			const auto track_element = (producer != nullptr) ? elements.find(producer) : elements.end();
+			if(track_element == elements.end())
+				continue;
+
+			const bool is_audio_track = is_audio || track->Attribute("hide", "video");
+			collectPlacements(track_element->second, is_audio_track, framerate, elements, producer_names, placements);
+		}
+		return;
+	}
+
+	// Playlists are a sequence of blanks and entries, whose out points are inclusive, so an entry lasts out - in + 1 frames
+	long time_frame = 0;
+	for(const XMLElement* ptr = element->FirstChildElement(); ptr != nullptr; ptr = ptr->NextSiblingElement()){
+		if( strcmp(ptr->Name(), "blank") == 0 ){
+			time_frame += convertToFrames(ptr->Attribute("length"), framerate);
+			continue;
+		}
+		if( strcmp(ptr->Name(), "entry") != 0 )
+			continue;
+
+		const long in_frame = convertToFrames(ptr->Attribute("in"), framerate);
+		const long length_frames = convertToFrames(ptr->Attribute("out"), framerate) - in_frame + 1;
+		const char* producer = ptr->Attribute("producer");
+		const auto name = (producer != nullptr) ? producer_names.find(producer) : producer_names.end();
+
+		if(name != producer_names.end()){
+			LoadedPlacement placement = { time_frame / framerate, &name->second, length_frames / framerate, in_frame / framerate, 0, 0, is_audio };
+
+			// Read the fades from the entry's filters, which fade video from and to black, and audio from and to silence
+			for(const XMLElement* filter = ptr->FirstChildElement("filter"); filter != nullptr; filter = filter->NextSiblingElement("filter")){
+				const char* kdenlive_id = findPropertyText(filter, "kdenlive_id");
+				if(kdenlive_id == nullptr)
+					continue;
+
+				const float fade_length = (convertToFrames(filter->Attribute("out"), framerate) - convertToFrames(filter->Attribute("in"), framerate) + 1) / framerate;
+				if( strcmp(kdenlive_id, "fade_from_black") == 0  ||  strcmp(kdenlive_id, "fadein") == 0 )
+					placement.fade_in_time = fade_length;
+				else if( strcmp(kdenlive_id, "fade_to_black") == 0  ||  strcmp(kdenlive_id, "fadeout") == 0 )
+					placement.fade_out_time = fade_length;
+			}
+
+			placements.push_back(placement);
+		}
+
+		time_frame += length_frames;
+	}
+}
+
+
+// SNAPSHOT LAYOUT
+// Every section starts on an 8 byte boundary, so the records can be read straight out of the mapped file
+const char SNAPSHOT_MAGIC[8] = { 'K', 'D', 'N', 'S', 'N', 'A', 'P', '\0' };
+// Each version adds sections after the timelines, so a snapshot of an earlier version is the start of one of the current version
+const uint32_t SNAPSHOT_VERSION = 4;
+const uint32_t SNAPSHOT_CLIP_USES_PROXY = 1;
+const uint32_t SNAPSHOT_CLIP_AUDIO_ROLE_SHIFT = 1;	// From version 3, the audio role of the clip is kept in the flags above SNAPSHOT_CLIP_USES_PROXY
+const uint32_t SNAPSHOT_CLIP_AUDIO_ROLE_MASK = 3;
+
+struct SnapshotHeader{
+	char magic[8];
+	uint32_t version;
+	float framerate;
+	int32_t frame_width;
+	int32_t frame_height;
+	uint64_t string_table_size;
+	uint64_t clip_count;
+	uint64_t video_entry_count;
+	uint64_t audio_entry_count;
+};
+struct SnapshotClip{
+	uint32_t name_offset;
+	uint32_t name_length;
+	float length;
+	float start_offset;
+	float fade_in_time;
+	float fade_out_time;
+	int32_t priority;
+	uint32_t flags;		// SNAPSHOT_CLIP_USES_PROXY, and the audio role
+};
+struct SnapshotTimelineEntry{
+	float time_stamp;
+	uint32_t clip_index;
+};
+// Version 2 adds the volume of each clip, in order of clip, followed by the keyframes of every clip in the same order
+struct SnapshotClipVolume{
+	float volume;
+	uint32_t keyframe_count;
+};
+struct SnapshotVolumeKeyframe{
+	float time_stamp;
+	float volume;
+};
+// Version 4 adds the number of markers of each clip, in order of clip, and then the number of guides,
+// followed by the markers of every clip in the same order, and then the guides. Their comments are kept in the string table
+struct SnapshotMarker{
+	float time_stamp;
+	int32_t category;
+	uint32_t comment_offset;
+	uint32_t comment_length;
+};
+static_assert(sizeof(SnapshotHeader) == 56, "SnapshotHeader must match the file layout");
+static_assert(sizeof(SnapshotClip) == 32, "SnapshotClip must match the file layout");
+static_assert(sizeof(SnapshotTimelineEntry) == 8, "SnapshotTimelineEntry must match the file layout");
+static_assert(sizeof(SnapshotClipVolume) == 8, "SnapshotClipVolume must match the file layout");
+static_assert(sizeof(SnapshotVolumeKeyframe) == 8, "SnapshotVolumeKeyframe must match the file layout");
+static_assert(sizeof(SnapshotMarker) == 16, "SnapshotMarker must match the file layout");
+
+bool isLittleEndianHost(){
+	const uint32_t value = 1;
+	char first_byte;
+	memcpy(&first_byte, &value, 1);
+	return first_byte == 1;
+}
+const bool IS_LITTLE_ENDIAN_HOST = isLittleEndianHost();
+
+// Converts between host and little-endian byte order. This is a no-op on little-endian hosts
+template<typename T>
+T swapToLittleEndian(const T value){
+	if(IS_LITTLE_ENDIAN_HOST)
+		return value;
+
+	char bytes[sizeof(T)];
+	memcpy(bytes, &value, sizeof(T));
+	for(size_t i = 0; i < sizeof(T) / 2; i++)
+		swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+
+	T swapped;
+	memcpy(&swapped, bytes, sizeof(T));
+	return swapped;
+}
+
+uint64_t alignSnapshotSize(const uint64_t size){
+	return (size + 7) & ~static_cast<uint64_t>(7);
+}
+
+
+// PROJECT HASHING
+// Streaming 64-bit FNV-1a hash. Values are hashed as little-endian bytes, so the hash is the same on every platform
+struct ProjectHasher{
+	uint64_t hash = 14695981039346656037ULL;
+
+	void AddBytes(const void* data, const size_t size){
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for(size_t i = 0; i < size; i++){
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+	}
+	void AddInt(const uint64_t value){
+		const uint64_t little_endian = swapToLittleEndian(value);
+		AddBytes(&little_endian, sizeof(little_endian));
+	}
+	void AddFloat(const float value){
+		const float little_endian = swapToLittleEndian(value);
+		AddBytes(&little_endian, sizeof(little_endian));
+	}
+	void AddString(const string &value){
+		AddInt(value.size());
+		AddBytes(value.data(), value.size());
+	}
+};
+
+string convertHashToString(const uint64_t hash){
+	char hash_str[17];
+	snprintf(hash_str, sizeof(hash_str), "%016llx", static_cast<unsigned long long>(hash));
+	return hash_str;
+}
+
+// Returns the project hash stored in an existing .kdenlive file, or an empty string if there isn't one
+string readProjectHash(const string &file_path){
+	MappedFile input_file(file_path);
+	if(!input_file.IsOpen()  ||  input_file.Size() == 0)
+		return "";
+
+	// The main bin is at the end of the file, so searching backwards for it only reads the end of the file
+	const string_view file_text(input_file.Data(), input_file.Size());
+	const size_t main_bin_start = file_text.rfind("<playlist id=\"main_bin\"");
+	if(main_bin_start == string_view::npos)
+		return "";
+
+	const string property_start = string("<property name=\"") + PROJECT_HASH_PROPERTY + "\">";
+	const size_t hash_start = file_text.find(property_start, main_bin_start);
+	if(hash_start == string_view::npos)
+		return "";
+
+	const size_t value_start = hash_start + property_start.size();
+	const size_t value_end = file_text.find('<', value_start);
+	if(value_end == string_view::npos)
+		return "";
+
+	return string(file_text.substr(value_start, value_end - value_start));
+}
+
+
+// TRACK ALLOCATION
+// The highest track taken by any clip over each span of time, where the spans are between the given times.
+// Both taking tracks over a range of spans, and finding the highest track taken over a range of spans, are O(log n)
+class TrackHeightTree{
+	public:
+	TrackHeightTree(const size_t span_count){
+		this->span_count = span_count;
+		// Heights are stored as track + 1, so 0 means no track is taken
+		covering_heights.resize(4 * span_count + 4, 0);
+		subtree_heights.resize(4 * span_count + 4, 0);
+	}
+
+	void TakeTrack(const size_t first_span, const size_t end_span, const int track){
+		if(first_span < end_span)
+			TakeTrack(1, 0, span_count, first_span, end_span, track + 1);
+	}
+	// Returns the highest track taken over the spans, or -1 if none are
+	int FindHighestTrack(const size_t first_span, const size_t end_span) const{
+		if(first_span >= end_span)
+			return -1;
+		return FindHeight(1, 0, span_count, first_span, end_span) - 1;
+	}
+
+	private:
+	void TakeTrack(const size_t node, const size_t node_first, const size_t node_end, const size_t first_span, const size_t end_span, const int height){
+		subtree_heights[node] = max(subtree_heights[node], height);
+		if(first_span <= node_first  &&  node_end <= end_span){
+			covering_heights[node] = max(covering_heights[node], height);
+			return;
+		}
+
+		const size_t node_middle = (node_first + node_end) / 2;
+		if(first_span < node_middle)
+			TakeTrack(2 * node, node_first, node_middle, first_span, end_span, height);
+		if(end_span > node_middle)
+			TakeTrack(2 * node + 1, node_middle, node_end, first_span, end_span, height);
+	}
+	int FindHeight(const size_t node, const size_t node_first, const size_t node_end, const size_t first_span, const size_t end_span) const{
+		if(first_span <= node_first  &&  node_end <= end_span)
+			return subtree_heights[node];
+
+		// A track taken over the whole node is taken over every part of it
+		int height = covering_heights[node];
+		const size_t node_middle = (node_first + node_end) / 2;
+		if(first_span < node_middle)
+			height = max(height, FindHeight(2 * node, node_first, node_middle, first_span, end_span));
+		if(end_span > node_middle)
+			height = max(height, FindHeight(2 * node + 1, node_middle, node_end, first_span, end_span));
+		return height;
+	}
+
+	size_t span_count;
+	vector<int> covering_heights;	// Highest track taken over the whole span of each node
+	vector<int> subtree_heights;	// Highest track taken over any part of the span of each node
+};
+
+
+// GENERATION STATS
+// Adds the time between its construction and destruction to a phase of the stats. Does nothing if there are no stats
+class PhaseTimer{
+	public:
+	PhaseTimer(GenerationStats* stats, double GenerationStats::*phase_seconds){
+		this->stats = stats;
+		this->phase_seconds = phase_seconds;
+		if(stats != nullptr)
+			start = chrono::steady_clock::now();
+	}
+	~PhaseTimer(){
+		if(stats != nullptr)
+			stats->*phase_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+
+	private:
+	GenerationStats* stats;
+	double GenerationStats::*phase_seconds;
+	chrono::steady_clock::time_point start;
+};
+
+// KdenliveFile::SetProfile() only takes whole framerates, so frames in the file are counted at this rate
+int getFileFramerate(const float framerate){
+	return static_cast<int>(framerate);
+}
+
+// Returns how far the music is lowered at the given time by a range of dialog, including the fades on either side of it, in dB
+float getDuckVolume(const pair<float, float> &duck_range, const float duck_volume, const float fade_time, const float time){
+	if(time <= duck_range.first - fade_time  ||  time >= duck_range.second + fade_time)
+		return 0;
+	if(time < duck_range.first)
+		return duck_volume * (time - (duck_range.first - fade_time)) / fade_time;
+	if(time > duck_range.second)
+		return duck_volume * (duck_range.second + fade_time - time) / fade_time;
+	return duck_volume;
+}
+
+string getOutputFilePath(const string &file_name, const string &output_filepath){
+	if(output_filepath != "")
+		return output_filepath + "/" + file_name + ".kdenlive";
+	else
+		return file_name + ".kdenlive";
+}
+
+
+// ProxySettings --------------------------------------------------
+bool ProxySettings::operator==(const ProxySettings &other) const{
+	return is_enabled == other.is_enabled  &&  min_frame_width == other.min_frame_width  &&  min_file_size == other.min_file_size
+		&& params == other.params  &&  extension == other.extension  &&  path_pattern == other.path_pattern;
+}
+bool ProxySettings::operator!=(const ProxySettings &other) const{
+	return !(*this == other);
+}
+
+// PreviewSettings --------------------------------------------------
+bool PreviewSettings::operator==(const PreviewSettings &other) const{
+	if(ranges.size() != other.ranges.size())
+		return false;
+	for(size_t i = 0; i < ranges.size(); i++){
+		if(ranges[i].start_time != other.ranges[i].start_time  ||  ranges[i].end_time != other.ranges[i].end_time)
+			return false;
+	}
+
+	return min_stacked_video_clips == other.min_stacked_video_clips  &&  include_fades == other.include_fades
+		&& extension == other.extension  &&  parameters == other.parameters;
+}
+bool PreviewSettings::operator!=(const PreviewSettings &other) const{
+	return !(*this == other);
+}
+
+
+// MixSettings --------------------------------------------------
+bool MixSettings::operator==(const MixSettings &other) const{
+	return max_overlap_length == other.max_overlap_length  &&  has_transitions == other.has_transitions;
+}
+bool MixSettings::operator!=(const MixSettings &other) const{
+	return !(*this == other);
+}
+
+// DuckingSettings --------------------------------------------------
+bool DuckingSettings::operator==(const DuckingSettings &other) const{
+	return is_enabled == other.is_enabled  &&  volume == other.volume  &&  fade_time == other.fade_time;
+}
+bool DuckingSettings::operator!=(const DuckingSettings &other) const{
+	return !(*this == other);
+}
+
+
+
 // Clip --------------------------------------------------
-Clip::Clip(const string &name, const float length, const float start_offset){
-	this->name = name;
+Clip::Clip(string name, const float length, const float start_offset){
+	this->name = move(name);
 	this->length = length;
 	this->start_offset = start_offset;
 }
 
 void Clip::SetBounds(const float length, const float start_offset){
-	if(length > 0)
+	if(length > 0  &&  length != this->length){
 		this->length = length;
+		project->video_index.MarkLengthsChanged();
+		project->audio_index.MarkLengthsChanged();
+	}
 	if(start_offset > 0)
 		this->start_offset = start_offset;
+
+	project->MarkChanged();
 }
 
 void Clip::SetFadeOffsets(const float fade_in_time, const float fade_out_time){
 	this->fade_in_time = fade_in_time;
 	this->fade_out_time = fade_out_time;
+
+	project->MarkChanged();
+}
+
+void Clip::SetPriority(const int priority){
+	this->priority = priority;
+
+	project->MarkChanged();
+}
+
+void Clip::SetUseProxy(const bool use_proxy){
+	this->use_proxy = use_proxy;
+
+	project->MarkChanged();
+}
+
+void Clip::SetVolume(const float volume){
+	this->volume = volume;
+
+	project->MarkChanged();
+}
+
+void Clip::SetVolumeKeyframes(const vector<VolumeKeyframe> &volume_keyframes){
+	project->keyframed_clip_count += static_cast<int>(!volume_keyframes.empty()) - static_cast<int>(!this->volume_keyframes.empty());
+	this->volume_keyframes = volume_keyframes;
+
+	project->MarkChanged();
+}
+
+void Clip::SetAudioRole(const AudioRole audio_role){
+	this->audio_role = audio_role;
+
+	project->MarkChanged();
+}
+
+void Clip::AddMarkers(const vector<Marker> &markers){
+	if(markers.empty())
+		return;
+
+	project->marked_clip_count += this->markers.empty();
+	this->markers.insert(this->markers.end(), markers.begin(), markers.end());
+
+	project->MarkChanged();
 }
 
 
@@ -60,6 +604,26 @@ KdenliveProject::KdenliveProject(){
 	this->frame_height = 1080;
 }
 
+KdenliveProject::~KdenliveProject(){
+	delete generated_file;
+}
+
+
+// TIME QUERIES
+vector<TimelineClip> KdenliveProject::FindClipsAt(const KdenliveFile::TrackType track_type, const float time_stamp) const{
+	vector<TimelineClip> found_clips;
+	(track_type == KdenliveFile::VIDEO ? video_index : audio_index).FindClipsAt(time_stamp, found_clips);
+
+	return found_clips;
+}
+
+vector<TimelineClip> KdenliveProject::FindClipsInRange(const KdenliveFile::TrackType track_type, const float start_time, const float end_time) const{
+	vector<TimelineClip> found_clips;
+	(track_type == KdenliveFile::VIDEO ? video_index : audio_index).FindClipsInRange(start_time, end_time, found_clips);
+
+	return found_clips;
+}
+
 
 // SETTERS
 void KdenliveProject::SetProfile(const float framerate, const int frame_width, const int frame_height){
@@ -69,18 +633,72 @@ void KdenliveProject::SetProfile(const float framerate, const int frame_width, c
 		this->frame_width = frame_width;
 	if(frame_height > 0)
 		this->frame_height = frame_height;
+
+	MarkChanged();
+}
+
+void KdenliveProject::SetProxySettings(const ProxySettings &proxy_settings){
+	this->proxy_settings = proxy_settings;
+
+	MarkChanged();
+}
+
+void KdenliveProject::SetPreviewSettings(const PreviewSettings &preview_settings){
+	this->preview_settings = preview_settings;
+
+	MarkChanged();
+}
+
+void KdenliveProject::SetMixSettings(const MixSettings &mix_settings){
+	this->mix_settings = mix_settings;
+
+	MarkChanged();
+}
+
+void KdenliveProject::SetCrossfades(const bool is_crossfading){
+	this->is_crossfading = is_crossfading;
+
+	MarkChanged();
+}
+
+void KdenliveProject::SetDuckingSettings(const DuckingSettings &ducking_settings){
+	this->ducking_settings = ducking_settings;
+
+	MarkChanged();
 }
 
 Clip* KdenliveProject::CreateClip(const string &name, const float length, const float start_offset){
-	clips.push_back(Clip(name, length, start_offset));
-	return &clips.back();
+	return AddNewClip(name, length, start_offset);
+}
+
+Clip* KdenliveProject::CreateSequenceClip(const string &name, KdenliveProject* sequence_project, const float length, const float start_offset){
+	if(sequence_project == nullptr  ||  sequence_project == this){
+		cerr << "Sequence clip '" << name << "' must play another project";
+		return nullptr;
+	}
+	// A project that already plays this one can't be played by it, or the sequences would play each other without end
+	if(sequence_project->sequence_clip_count > 0){
+		const vector<KdenliveProject*> nested_projects = sequence_project->FindSequenceProjects();
+		if(find(nested_projects.begin(), nested_projects.end(), this) != nested_projects.end()){
+			cerr << "Sequence clip '" << name << "' must not play a project that plays this one";
+			return nullptr;
+		}
+	}
+
+	Clip* new_clip = AddNewClip(name, length, start_offset);
+	new_clip->sequence = sequence_project;
+	sequence_clip_count++;
+
+	return new_clip;
 }
 
 void KdenliveProject::AddClipToVideoTrack(const float time_stamp, Clip* clip){
-	video_timeline.insert( { time_stamp, clip} );
+	AddToTimeline(KdenliveFile::VIDEO, time_stamp, clip);
+	MarkChanged();
 }
 void KdenliveProject::AddClipToAudioTrack(const float time_stamp, Clip* clip){
-	audio_timeline.insert( { time_stamp, clip} );
+	AddToTimeline(KdenliveFile::AUDIO, time_stamp, clip);
+	MarkChanged();
 }
 
 Clip* KdenliveProject::CreateClipOnVideoTrack(const float time_stamp, const string &name, const float length, const float start_offset){
@@ -97,122 +715,1908 @@ Clip* KdenliveProject::CreateClipOnAudioTrack(const float time_stamp, const stri
 
 	return new_clip;
 }
-	
 
-// GENERATE PROJECT FILE
-KdenliveFile* KdenliveProject::GenerateFile(const vector<string> &media_folder_paths){ // Kind of a mess, needs reworking
-	// Reset the file
-	//kdenlive_file.~KdenliveFile();	// Destructor doesn't do anything currently
-	//new (&kdenlive_file) KdenliveFile();
-	
-	KdenliveFile* kdenlive_file = new KdenliveFile;
-	
-	// Start the document
-	kdenlive_file->SetProfile(framerate, frame_width, frame_height);
-	
-	// Add all filepaths to the KdenliveFile file
-	map<string, ClipId> included_names = map<string, ClipId>();
-	
-	for(const Clip clip : clips){
-		
-		// Check if the clip has not been to the file
-		if(included_names.find(clip.name) == included_names.end()){
-			// Find the filepath to use for this clip
-			const string filepath = findFilePath(media_folder_paths, clip.name);
-			// Add the clip the the KdenliveFile bin
-			ClipId clip_id = kdenlive_file->AddClipToBin(filepath);
-			
-			// Add clip_id to included_names map
-			included_names.insert( {clip.name, clip_id} );
-		}
+int KdenliveProject::ImportManifest(const string &manifest_path){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::ImportManifest");
+
+	MappedFile manifest(manifest_path);
+
+	if(!manifest.IsOpen()){
+		cerr << "File '" << manifest_path << "' not found";
+		return 0;
 	}
-	
-	// Macro that adds a clip to a track
-	#define ADD_CLIP	float blank_length = entry_start_time - track_length;														\
-						if( blank_length > 0.00099)																					\
-						kdenlive_file->AddBlankToTrack(track_id, blank_length);														\
-						ClipId clip_id = included_names.at(clip->name);																\
-						TrackEntryId entry_id = kdenlive_file->AddClipToTrack(track_id, clip_id, clip->length, clip->start_offset);	\
-						kdenlive_file->FadeClip(track_id, entry_id, clip->fade_in_time, clip->fade_out_time);						\
-	
-	// Add video clips
-	vector<TrackId> video_tracks;
-	
-	for(auto video : video_timeline){
-		const float entry_start_time = video.first;
-		const Clip* clip = video.second;
-		
-		// Check for availible tracks from the bottom up
-		for(int i = 0; i < video_tracks.size(); i++){
-			TrackId track_id = video_tracks[i];
-			float track_length = kdenlive_file->GetTrackLength(track_id);
-		
-			// Check if clip can fit on track
-			if( track_length <= entry_start_time ){
-				ADD_CLIP
-				goto video_continue;
-			}
-		}
-		{
-		// If there was no availible track, create a new one and add it there
-		TrackId track_id = kdenlive_file->AddTrack(KdenliveFile::VIDEO);		
-		video_tracks.push_back(track_id);
-		float track_length = 0;
-		ADD_CLIP
+	if(manifest.Size() == 0)
+		return 0;
+
+	const char* ptr = manifest.Data();
+	const char* const file_end = ptr + manifest.Size();
+
+	// Use tabs as the delimiter if the first line has any
+	const char* first_line_end = static_cast<const char*>( memchr(ptr, '\n', file_end - ptr) );
+	if(first_line_end == nullptr)
+		first_line_end = file_end;
+	const char delimiter = (memchr(ptr, '\t', first_line_end - ptr) != nullptr) ? '\t' : ',';
+
+	ManifestField fields[MANIFEST_COLUMN_COUNT];
+	bool is_first_row = true;
+	int imported_count = 0;
+
+	while(ptr < file_end){
+		// Find the bounds of this line
+		const char* line_end = static_cast<const char*>( memchr(ptr, '\n', file_end - ptr) );
+		if(line_end == nullptr)
+			line_end = file_end;
+		const char* line_begin = ptr;
+		ptr = (line_end < file_end) ? line_end + 1 : file_end;
+
+		if(line_end > line_begin && line_end[-1] == '\r')
+			line_end--;
+
+		// Skip blank lines and comments
+		if(line_end == line_begin || *line_begin == '#')
+			continue;
+
+		const int field_count = tokenizeManifestLine(line_begin, line_end, delimiter, fields, MANIFEST_COLUMN_COUNT);
+		for(int i = field_count; i < MANIFEST_COLUMN_COUNT; i++)
+			fields[i] = { line_end, line_end };
+
+		// Parse the row. The first row may be a header, in which case its time won't parse
+		float time_stamp, length, start_offset, fade_in_time, fade_out_time;
+		const bool is_valid_row = field_count >= 3
+			&& fields[0].begin != fields[0].end  &&  parseManifestFloat(fields[0], time_stamp, 0)
+			&& fields[1].begin != fields[1].end
+			&& fields[2].begin != fields[2].end  &&  parseManifestFloat(fields[2], length, 0)
+			&& parseManifestFloat(fields[3], start_offset, 0)
+			&& parseManifestFloat(fields[4], fade_in_time, 0)
+			&& parseManifestFloat(fields[5], fade_out_time, 0);
+
+		if(!is_valid_row){
+			if(!is_first_row)
+				cerr << "Skipping malformed manifest row: " << string(line_begin, line_end) << "\n";
+			is_first_row = false;
+			continue;
 		}
+		is_first_row = false;
+
+		// Only the first letter of the track type matters
+		const char track_type = (fields[6].begin != fields[6].end) ? (*fields[6].begin | 0x20) : 'v';
 
-		video_continue: ;
+		Clip* clip = AddNewClip( string(fields[1].begin, fields[1].end), length, start_offset );
+		clip->fade_in_time = fade_in_time;
+		clip->fade_out_time = fade_out_time;
+
+		if(track_type != 'a')
+			AddToTimeline(KdenliveFile::VIDEO, time_stamp, clip);
+		if(track_type == 'a'  ||  track_type == 'b')
+			AddToTimeline(KdenliveFile::AUDIO, time_stamp, clip);
+
+		imported_count++;
 	}
+
+	return imported_count;
+}
+
+void KdenliveProject::AddGuides(const vector<Marker> &guides){
+	if(guides.empty())
+		return;
+
+	this->guides.insert(this->guides.end(), guides.begin(), guides.end());
+
+	MarkChanged();
+}
 	
-	// Add audio clips
-	vector<TrackId> audio_tracks;
-	
-	for(auto audio : audio_timeline){
-		float entry_start_time = audio.first;
-		Clip* clip = audio.second;
-		// Check for availible tracks from the bottom up
-		for(int i = 0; i < audio_tracks.size(); i++){
-			TrackId track_id = audio_tracks[i];
-			float track_length = kdenlive_file->GetTrackLength(track_id);
-
-			// Check if clip can fit on track AND has
-			if( track_length <= entry_start_time ){
-				ADD_CLIP
-				goto audio_continue;
-			}
+
+// LOAD PROJECT FILE
+bool KdenliveProject::LoadFromFile(const string &file_path){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::LoadFromFile");
+
+	MappedFile input_file(file_path);
+
+	if(!input_file.IsOpen()){
+		cerr << "File '" << file_path << "' not found";
+		return false;
+	}
+
+	// tinyxml2 copies the mapped text into its own buffer once, and then parses that buffer in place
+	XMLDocument xml_doc;
+	if( input_file.Size() == 0  ||  xml_doc.Parse(input_file.Data(), input_file.Size()) != XML_SUCCESS ){
+		cerr << "File '" << file_path << "' could not be parsed";
+		return false;
+	}
+
+	const XMLElement* root = xml_doc.RootElement();
+
+	// Read the profile, which is only applied once the file is known to have a timeline.
+	// Without a usable framerate, frame counts in the file are read at the framerate of this project
+	float file_framerate = 0;
+	int file_width = 0, file_height = 0;
+	const XMLElement* profile = root->FirstChildElement("profile");
+	if(profile != nullptr){
+		const int frame_rate_num = profile->IntAttribute("frame_rate_num", 0);
+		const int frame_rate_den = profile->IntAttribute("frame_rate_den", 1);
+		file_framerate = (frame_rate_num > 0  &&  frame_rate_den > 0) ? static_cast<float>(frame_rate_num) / frame_rate_den : 0;
+		file_width = profile->IntAttribute("width", 0);
+		file_height = profile->IntAttribute("height", 0);
+	}
+	const float load_framerate = (file_framerate > 0) ? file_framerate : framerate;
+
+	// Index the playlists and tractors by id, and name every media producer by its resource
+	unordered_map<string, const XMLElement*> elements;
+	unordered_map<string, string> producer_names;
+	const XMLElement* main_bin = nullptr;
+	const XMLElement* last_tractor = nullptr;
+
+	for(const XMLElement* ptr = root->FirstChildElement(); ptr != nullptr; ptr = ptr->NextSiblingElement()){
+		const char* id = ptr->Attribute("id");
+		if(id == nullptr)
+			continue;
+
+		if( strcmp(ptr->Name(), "playlist") == 0  ||  strcmp(ptr->Name(), "tractor") == 0 ){
+			elements.emplace(id, ptr);
+
+			if( strcmp(ptr->Name(), "tractor") == 0 )
+				last_tractor = ptr;
+			else if( strcmp(id, "main_bin") == 0 )
+				main_bin = ptr;
 		}
-		{
-		// If there was no availible track, create a new one and add it there
-		TrackId track_id = kdenlive_file->AddTrack(KdenliveFile::AUDIO);
-		audio_tracks.push_back(track_id);
-		float track_length = 0;
-		ADD_CLIP
+		else if( strcmp(ptr->Name(), "chain") == 0  ||  strcmp(ptr->Name(), "producer") == 0 ){
+			// The black background track is not a clip
+			const char* playlist_id = findPropertyText(ptr, "kdenlive:playlistid");
+			const char* resource = findPropertyText(ptr, "resource");
+			if( resource == nullptr  ||  (playlist_id != nullptr && strcmp(playlist_id, "black_track") == 0) )
+				continue;
+
+			producer_names.emplace(id, fs::path(resource).stem().string());
 		}
-		
-		audio_continue: ;
 	}
-	
-	return kdenlive_file;
-}
 
-string KdenliveProject::SaveAsString(const vector<string> &media_folder_paths){
-	// Generate the file
-	KdenliveFile* file = GenerateFile(media_folder_paths);
+	// The timeline is the tractor with the document's UUID. Older files without one keep their tracks in the last tractor
+	const XMLElement* timeline_tractor = last_tractor;
+	const char* doc_uuid = (main_bin != nullptr) ? findPropertyText(main_bin, "kdenlive:docproperties.uuid") : nullptr;
+	if(doc_uuid != nullptr  &&  elements.count(doc_uuid) > 0)
+		timeline_tractor = elements.at(doc_uuid);
 
-	const string file_str = file->ToString();
+	if(timeline_tractor == nullptr){
+		cerr << "File '" << file_path << "' has no timeline";
+		return false;
+	}
 
-	// Deallocate the file
-	delete file;
+	// Collect every placement on every track
+	vector<LoadedPlacement> placements;
+	collectPlacements(timeline_tractor, false, load_framerate, elements, producer_names, placements);
 
-	return file_str;
-}
+	// The bin lists the media in the order their first clips were created, which the clips are created in again below
+	unordered_map<string_view, size_t> bin_indices;
+	for(const XMLElement* ptr = (main_bin != nullptr) ? main_bin->FirstChildElement("entry") : nullptr; ptr != nullptr; ptr = ptr->NextSiblingElement("entry")){
+		const char* producer = ptr->Attribute("producer");
+		const auto name = (producer != nullptr) ? producer_names.find(producer) : producer_names.end();
+		if(name != producer_names.end())
+			bin_indices.emplace(name->second, bin_indices.size());
+	}
+	auto getBinIndex = [&bin_indices](const LoadedPlacement &placement){
+		const auto bin_index = bin_indices.find(*placement.name);
+		return (bin_index != bin_indices.end()) ? bin_index->second : bin_indices.size();
+	};
 
-void KdenliveProject::SaveToFile(const vector<string> &media_folder_paths, const string &file_name, const string &output_filepath){
-	// Generate the file
-	KdenliveFile* file = GenerateFile(media_folder_paths);
-	
-	file->SaveToFile(file_name, output_filepath);
+	vector<size_t> creation_order(placements.size());
+	iota(creation_order.begin(), creation_order.end(), 0);
+	stable_sort(creation_order.begin(), creation_order.end(), [&placements, &getBinIndex](const size_t a, const size_t b){
+		return getBinIndex(placements[a]) < getBinIndex(placements[b]);
+	});
 
-	// Deallocate the file
-	delete file;
+	// Rebuild the model
+	ClearModel();
+	SetProfile(file_framerate, file_width, file_height);
+
+	vector<Clip*> loaded_clips(placements.size());
+	for(const size_t i : creation_order){
+		const LoadedPlacement &placement = placements[i];
+		loaded_clips[i] = AddNewClip( *placement.name, placement.length, placement.start_offset );
+		loaded_clips[i]->fade_in_time = placement.fade_in_time;
+		loaded_clips[i]->fade_out_time = placement.fade_out_time;
+	}
+
+	// The placements were collected from the first track up, so clips that start together are given back the tracks they were saved on
+	for(size_t i = 0; i < placements.size(); i++){
+		if(placements[i].is_audio)
+			AddClipToAudioTrack(placements[i].time_stamp, loaded_clips[i]);
+		else
+			AddClipToVideoTrack(placements[i].time_stamp, loaded_clips[i]);
+	}
+
+	return true;
+}
+
+
+// SNAPSHOTS
+bool KdenliveProject::SaveSnapshot(const string &file_path) const{
+	KDENCODE_TRACE_SCOPE("KdenliveProject::SaveSnapshot");
+
+	// A snapshot only holds this project, so the projects sequences play can't be restored from it
+	if(sequence_clip_count > 0){
+		cerr << "Snapshot can't be saved to '" << file_path << "', because the project contains sequence clips";
+		return false;
+	}
+
+	// Build the string table, storing each unique name and comment once
+	string string_table;
+	unordered_map<string_view, uint32_t> name_offsets;
+	name_offsets.reserve(clips.size());
+	auto addString = [&string_table, &name_offsets](const string &str){
+		const auto name_offset = name_offsets.emplace(str, static_cast<uint32_t>(string_table.size()));
+		if(name_offset.second)
+			string_table += str;
+		return name_offset.first->second;
+	};
+
+	vector<SnapshotClip> clip_records;
+	clip_records.reserve(clips.size());
+	vector<SnapshotClipVolume> volume_records;
+	volume_records.reserve(clips.size());
+	vector<SnapshotVolumeKeyframe> keyframe_records;
+	vector<uint32_t> marker_counts;
+	marker_counts.reserve(clips.size());
+	vector<SnapshotMarker> marker_records;
+
+	auto addMarkerRecords = [&marker_records, &addString](const vector<Marker> &markers){
+		for(const Marker &marker : markers){
+			SnapshotMarker record;
+			record.time_stamp = swapToLittleEndian(marker.time_stamp);
+			record.category = swapToLittleEndian(static_cast<int32_t>(marker.category));
+			record.comment_offset = swapToLittleEndian(addString(marker.comment));
+			record.comment_length = swapToLittleEndian(static_cast<uint32_t>(marker.comment.size()));
+			marker_records.push_back(record);
+		}
+	};
+
+	for(const Clip &clip : clips){
+		const uint32_t name_offset = addString(clip.name);
+		addMarkerRecords(clip.markers);
+
+		if(string_table.size() > UINT32_MAX){
+			cerr << "Snapshot string table is too large for '" << file_path << "'";
+			return false;
+		}
+
+		SnapshotClip record;
+		record.name_offset = swapToLittleEndian(name_offset);
+		record.name_length = swapToLittleEndian(static_cast<uint32_t>(clip.name.size()));
+		record.length = swapToLittleEndian(clip.length);
+		record.start_offset = swapToLittleEndian(clip.start_offset);
+		record.fade_in_time = swapToLittleEndian(clip.fade_in_time);
+		record.fade_out_time = swapToLittleEndian(clip.fade_out_time);
+		record.priority = swapToLittleEndian(static_cast<int32_t>(clip.priority));
+		record.flags = swapToLittleEndian( (clip.use_proxy ? SNAPSHOT_CLIP_USES_PROXY : 0)
+										   | (static_cast<uint32_t>(clip.audio_role) << SNAPSHOT_CLIP_AUDIO_ROLE_SHIFT) );
+		clip_records.push_back(record);
+
+		volume_records.push_back( {swapToLittleEndian(clip.volume), swapToLittleEndian(static_cast<uint32_t>(clip.volume_keyframes.size()))} );
+		for(const VolumeKeyframe &keyframe : clip.volume_keyframes)
+			keyframe_records.push_back( {swapToLittleEndian(keyframe.time_stamp), swapToLittleEndian(keyframe.volume)} );
+		marker_counts.push_back( swapToLittleEndian(static_cast<uint32_t>(clip.markers.size())) );
+	}
+	marker_counts.resize( alignSnapshotSize(marker_counts.size() * sizeof(uint32_t)) / sizeof(uint32_t), 0 );
+
+	// The guides follow the markers of the clips
+	addMarkerRecords(guides);
+	if(string_table.size() > UINT32_MAX){
+		cerr << "Snapshot string table is too large for '" << file_path << "'";
+		return false;
+	}
+	const uint64_t guide_count = swapToLittleEndian(static_cast<uint64_t>(guides.size()));
+
+	// Flatten the timelines, referring to clips by their index
+	vector<SnapshotTimelineEntry> timeline_records;
+	timeline_records.reserve(video_timeline.size() + audio_timeline.size());
+
+	for(const auto &timeline : { &video_timeline, &audio_timeline }){
+		for(const auto &placement : *timeline){
+			SnapshotTimelineEntry record;
+			record.time_stamp = swapToLittleEndian(placement.first);
+			record.clip_index = swapToLittleEndian(static_cast<uint32_t>(placement.second->index));
+			timeline_records.push_back(record);
+		}
+	}
+
+	SnapshotHeader header;
+	memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+	header.version = swapToLittleEndian(SNAPSHOT_VERSION);
+	header.framerate = swapToLittleEndian(framerate);
+	header.frame_width = swapToLittleEndian(static_cast<int32_t>(frame_width));
+	header.frame_height = swapToLittleEndian(static_cast<int32_t>(frame_height));
+	header.string_table_size = swapToLittleEndian(static_cast<uint64_t>(string_table.size()));
+	header.clip_count = swapToLittleEndian(static_cast<uint64_t>(clip_records.size()));
+	header.video_entry_count = swapToLittleEndian(static_cast<uint64_t>(video_timeline.size()));
+	header.audio_entry_count = swapToLittleEndian(static_cast<uint64_t>(audio_timeline.size()));
+
+	// Write every section
+	ofstream output(file_path, ios::binary);
+	if(!output.good()){
+		cerr << "File '" << file_path << "' could not be opened for writing";
+		return false;
+	}
+
+	string_table.resize( alignSnapshotSize(string_table.size()), '\0' );
+
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	output.write(string_table.data(), string_table.size());
+	output.write(reinterpret_cast<const char*>(clip_records.data()), clip_records.size() * sizeof(SnapshotClip));
+	output.write(reinterpret_cast<const char*>(timeline_records.data()), timeline_records.size() * sizeof(SnapshotTimelineEntry));
+	output.write(reinterpret_cast<const char*>(volume_records.data()), volume_records.size() * sizeof(SnapshotClipVolume));
+	output.write(reinterpret_cast<const char*>(keyframe_records.data()), keyframe_records.size() * sizeof(SnapshotVolumeKeyframe));
+	output.write(reinterpret_cast<const char*>(marker_counts.data()), marker_counts.size() * sizeof(uint32_t));
+	output.write(reinterpret_cast<const char*>(&guide_count), sizeof(guide_count));
+	output.write(reinterpret_cast<const char*>(marker_records.data()), marker_records.size() * sizeof(SnapshotMarker));
+	output.close();
+
+	return output.good();
+}
+
+bool KdenliveProject::LoadSnapshot(const string &file_path){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::LoadSnapshot");
+
+	MappedFile snapshot(file_path);
+
+	if(!snapshot.IsOpen()){
+		cerr << "File '" << file_path << "' not found";
+		return false;
+	}
+
+	// Every check of the layout fails the same way
+	auto rejectSnapshot = [&file_path](){
+		cerr << "File '" << file_path << "' is not a valid snapshot";
+		return false;
+	};
+
+	// Read and check the header
+	SnapshotHeader header;
+	if(snapshot.Size() < sizeof(header))
+		return rejectSnapshot();
+	memcpy(&header, snapshot.Data(), sizeof(header));
+
+	const uint64_t string_table_size = swapToLittleEndian(header.string_table_size);
+	const uint64_t clip_count = swapToLittleEndian(header.clip_count);
+	const uint64_t video_entry_count = swapToLittleEndian(header.video_entry_count);
+	const uint64_t audio_entry_count = swapToLittleEndian(header.audio_entry_count);
+
+	const uint64_t file_size = snapshot.Size();
+	const uint32_t version = swapToLittleEndian(header.version);
+	const bool has_valid_header = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0
+		&& version >= 1  &&  version <= SNAPSHOT_VERSION
+		&& string_table_size <= file_size  &&  clip_count <= file_size
+		&& video_entry_count <= file_size  &&  audio_entry_count <= file_size;
+
+	// Find each section of the first version
+	const uint64_t clips_offset = sizeof(header) + alignSnapshotSize(string_table_size);
+	const uint64_t timeline_offset = clips_offset + clip_count * sizeof(SnapshotClip);
+	const uint64_t volumes_offset = timeline_offset + (video_entry_count + audio_entry_count) * sizeof(SnapshotTimelineEntry);
+
+	if(!has_valid_header  ||  volumes_offset > file_size)
+		return rejectSnapshot();
+
+	const char* string_table = snapshot.Data() + sizeof(header);
+	const char* clip_data = snapshot.Data() + clips_offset;
+	const char* timeline_data = snapshot.Data() + timeline_offset;
+	const char* volume_data = snapshot.Data() + volumes_offset;
+
+	// Validate every reference before replacing the model
+	for(uint64_t i = 0; i < clip_count; i++){
+		SnapshotClip record;
+		memcpy(&record, clip_data + i * sizeof(SnapshotClip), sizeof(record));
+
+		if( static_cast<uint64_t>(swapToLittleEndian(record.name_offset)) + swapToLittleEndian(record.name_length) > string_table_size )
+			return rejectSnapshot();
+		if( ((swapToLittleEndian(record.flags) >> SNAPSHOT_CLIP_AUDIO_ROLE_SHIFT) & SNAPSHOT_CLIP_AUDIO_ROLE_MASK) > Clip::MUSIC )
+			return rejectSnapshot();
+	}
+	for(uint64_t i = 0; i < video_entry_count + audio_entry_count; i++){
+		SnapshotTimelineEntry record;
+		memcpy(&record, timeline_data + i * sizeof(SnapshotTimelineEntry), sizeof(record));
+
+		if( swapToLittleEndian(record.clip_index) >= clip_count )
+			return rejectSnapshot();
+	}
+
+	// The volume of each clip and the keyframes of every clip follow the timelines, from version 2
+	const bool has_volumes = (version >= 2);
+	const uint64_t keyframes_offset = volumes_offset + (has_volumes ? clip_count * sizeof(SnapshotClipVolume) : 0);
+	if(keyframes_offset > file_size)
+		return rejectSnapshot();
+
+	uint64_t volume_keyframe_count = 0;
+	for(uint64_t i = 0; has_volumes  &&  i < clip_count; i++){
+		SnapshotClipVolume record;
+		memcpy(&record, volume_data + i * sizeof(SnapshotClipVolume), sizeof(record));
+		volume_keyframe_count += swapToLittleEndian(record.keyframe_count);
+	}
+	if(volume_keyframe_count > file_size  ||  keyframes_offset + volume_keyframe_count * sizeof(SnapshotVolumeKeyframe) > file_size)
+		return rejectSnapshot();
+
+	// The number of markers of each clip and the number of guides follow the keyframes, and then the markers themselves, from version 4
+	const bool has_markers = (version >= 4);
+	const uint64_t marker_counts_offset = keyframes_offset + volume_keyframe_count * sizeof(SnapshotVolumeKeyframe);
+	const uint64_t guide_count_offset = marker_counts_offset + alignSnapshotSize(clip_count * sizeof(uint32_t));
+	const uint64_t markers_offset = guide_count_offset + sizeof(uint64_t);
+	if(has_markers  &&  markers_offset > file_size)
+		return rejectSnapshot();
+
+	uint64_t clip_marker_count = 0;
+	uint64_t guide_count = 0;
+	if(has_markers){
+		for(uint64_t i = 0; i < clip_count; i++){
+			uint32_t marker_count;
+			memcpy(&marker_count, snapshot.Data() + marker_counts_offset + i * sizeof(uint32_t), sizeof(marker_count));
+			clip_marker_count += swapToLittleEndian(marker_count);
+		}
+		memcpy(&guide_count, snapshot.Data() + guide_count_offset, sizeof(guide_count));
+		guide_count = swapToLittleEndian(guide_count);
+	}
+	if(has_markers  &&  (clip_marker_count > file_size  ||  guide_count > file_size
+						 ||  markers_offset + (clip_marker_count + guide_count) * sizeof(SnapshotMarker) > file_size))
+		return rejectSnapshot();
+
+	const char* marker_data = snapshot.Data() + markers_offset;
+	for(uint64_t i = 0; i < clip_marker_count + guide_count; i++){
+		SnapshotMarker record;
+		memcpy(&record, marker_data + i * sizeof(SnapshotMarker), sizeof(record));
+
+		if( static_cast<uint64_t>(swapToLittleEndian(record.comment_offset)) + swapToLittleEndian(record.comment_length) > string_table_size )
+			return rejectSnapshot();
+	}
+
+	// Rebuild the model
+	framerate = swapToLittleEndian(header.framerate);
+	frame_width = swapToLittleEndian(header.frame_width);
+	frame_height = swapToLittleEndian(header.frame_height);
+
+	ClearModel();
+
+	for(uint64_t i = 0; i < clip_count; i++){
+		SnapshotClip record;
+		memcpy(&record, clip_data + i * sizeof(SnapshotClip), sizeof(record));
+
+		const char* name = string_table + swapToLittleEndian(record.name_offset);
+		Clip* clip = AddNewClip( string(name, swapToLittleEndian(record.name_length)),
+								 swapToLittleEndian(record.length),
+								 swapToLittleEndian(record.start_offset) );
+		clip->fade_in_time = swapToLittleEndian(record.fade_in_time);
+		clip->fade_out_time = swapToLittleEndian(record.fade_out_time);
+		clip->priority = swapToLittleEndian(record.priority);
+		clip->use_proxy = (swapToLittleEndian(record.flags) & SNAPSHOT_CLIP_USES_PROXY) != 0;
+		clip->audio_role = static_cast<Clip::AudioRole>( (swapToLittleEndian(record.flags) >> SNAPSHOT_CLIP_AUDIO_ROLE_SHIFT) & SNAPSHOT_CLIP_AUDIO_ROLE_MASK );
+	}
+
+	// The keyframes are in order of clip, so each clip takes the next ones
+	const char* keyframe_data = snapshot.Data() + keyframes_offset;
+	vector<VolumeKeyframe> volume_keyframes;
+	for(uint64_t i = 0; has_volumes  &&  i < clip_count; i++){
+		SnapshotClipVolume record;
+		memcpy(&record, volume_data + i * sizeof(SnapshotClipVolume), sizeof(record));
+
+		volume_keyframes.resize(swapToLittleEndian(record.keyframe_count));
+		for(VolumeKeyframe &keyframe : volume_keyframes){
+			SnapshotVolumeKeyframe keyframe_record;
+			memcpy(&keyframe_record, keyframe_data, sizeof(keyframe_record));
+			keyframe_data += sizeof(keyframe_record);
+
+			keyframe.time_stamp = swapToLittleEndian(keyframe_record.time_stamp);
+			keyframe.volume = swapToLittleEndian(keyframe_record.volume);
+		}
+		clips[i].SetVolume(swapToLittleEndian(record.volume));
+		clips[i].SetVolumeKeyframes(volume_keyframes);
+	}
+
+	// The markers are in order of clip too, and the guides come after them
+	auto readMarkers = [&marker_data, string_table](const uint64_t count){
+		vector<Marker> markers(count);
+		for(Marker &marker : markers){
+			SnapshotMarker record;
+			memcpy(&record, marker_data, sizeof(record));
+			marker_data += sizeof(record);
+
+			marker.time_stamp = swapToLittleEndian(record.time_stamp);
+			marker.comment.assign(string_table + swapToLittleEndian(record.comment_offset), swapToLittleEndian(record.comment_length));
+			marker.category = swapToLittleEndian(record.category);
+		}
+		return markers;
+	};
+	for(uint64_t i = 0; has_markers  &&  i < clip_count; i++){
+		uint32_t marker_count;
+		memcpy(&marker_count, snapshot.Data() + marker_counts_offset + i * sizeof(uint32_t), sizeof(marker_count));
+		clips[i].AddMarkers(readMarkers(swapToLittleEndian(marker_count)));
+	}
+	AddGuides(readMarkers(guide_count));
+
+	// The timelines were saved in order, so every insert goes at the end
+	for(uint64_t i = 0; i < video_entry_count + audio_entry_count; i++){
+		SnapshotTimelineEntry record;
+		memcpy(&record, timeline_data + i * sizeof(SnapshotTimelineEntry), sizeof(record));
+
+		AddToTimeline( (i < video_entry_count) ? KdenliveFile::VIDEO : KdenliveFile::AUDIO,
+					   swapToLittleEndian(record.time_stamp), &clips[swapToLittleEndian(record.clip_index)] );
+	}
+
+	return true;
+}
+
+
+// GENERATE PROJECT FILE
+void KdenliveProject::SetIncrementalGeneration(const bool is_incremental){
+	this->is_incremental = is_incremental;
+
+	// Nothing needs to be kept when generating from scratch
+	if(!is_incremental){
+		delete generated_file;
+		generated_file = nullptr;
+		generated_tracks.clear();
+		generated_bin_ids.clear();
+	}
+}
+
+void KdenliveProject::SetFillGaps(const bool is_filling_gaps){
+	this->is_filling_gaps = is_filling_gaps;
+
+	MarkChanged();
+}
+
+bool KdenliveProject::TrackPlacement::operator==(const TrackPlacement &other) const{
+	return track_index == other.track_index  &&  time_stamp == other.time_stamp  &&  blank_length == other.blank_length  &&  clip == other.clip
+		&& length == other.length  &&  start_offset == other.start_offset
+		&& fade_in_time == other.fade_in_time  &&  fade_out_time == other.fade_out_time
+		&& is_in_mix_playlist == other.is_in_mix_playlist  &&  mix_length == other.mix_length  &&  volume == other.volume;
+}
+bool KdenliveProject::TrackPlacement::operator!=(const TrackPlacement &other) const{
+	return !(*this == other);
+}
+
+int KdenliveProject::AllocateTracks(const multimap<float, Clip*> &timeline, vector<TrackPlacement> &placements, const bool is_layered_by_priority) const{
+	// Priorities only matter if they differ, and otherwise the tracks are the same as without them
+	if(is_layered_by_priority  &&  !timeline.empty()){
+		const int first_priority = timeline.begin()->second->priority;
+		for(const auto &timeline_entry : timeline){
+			if(timeline_entry.second->priority != first_priority)
+				return AllocateTracksByPriority(timeline, placements);
+		}
+	}
+	if(is_filling_gaps)
+		return AllocateTracksFillingGaps(timeline, placements);
+	if(mix_settings.max_overlap_length > 0)
+		return AllocateTracksMixingOverlaps(timeline, placements);
+
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AllocateTracks");
+
+	// The length of each track, measured the same way as KdenliveFile::GetTrackLength()
+	vector<float> track_lengths;
+	placements.reserve(placements.size() + timeline.size());
+
+	// Sweep through the clips in order of time. Tracks that are still playing wait in a heap ordered by the time they end,
+	// and move to the free tracks once a clip starts at or after that time, so each clip is placed in O(log n) time
+	priority_queue<pair<float, int>, vector<pair<float, int>>, greater<pair<float, int>>> busy_tracks;
+	set<int> free_tracks;
+
+	for(const auto &timeline_entry : timeline){
+		const float entry_start_time = timeline_entry.first;
+		const Clip* clip = timeline_entry.second;
+
+		while(!busy_tracks.empty()  &&  busy_tracks.top().first <= entry_start_time){
+			free_tracks.insert(busy_tracks.top().second);
+			busy_tracks.pop();
+		}
+
+		// Use the lowest availible track. If there was no availible track, create a new one
+		int track_index;
+		if(!free_tracks.empty()){
+			track_index = *free_tracks.begin();
+			free_tracks.erase(free_tracks.begin());
+		}
+		else{
+			track_index = track_lengths.size();
+			track_lengths.push_back(0);
+		}
+
+		// Blanks that are too short are not added
+		float blank_length = entry_start_time - track_lengths[track_index];
+		if(blank_length > MIN_BLANK_LENGTH)
+			track_lengths[track_index] += blank_length;
+		else
+			blank_length = 0;
+		track_lengths[track_index] += clip->length;
+		busy_tracks.emplace(track_lengths[track_index], track_index);
+
+		placements.push_back( { track_index, entry_start_time, blank_length, clip, clip->length, clip->start_offset, clip->fade_in_time, clip->fade_out_time, false, 0, clip->volume } );
+	}
+
+	return track_lengths.size();
+}
+
+int KdenliveProject::AllocateTracksFillingGaps(const multimap<float, Clip*> &timeline, vector<TrackPlacement> &placements) const{
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AllocateTracksFillingGaps");
+
+	// Visit the placements in the order their clips were created. The sort is stable, so each clip's placements stay in order of time
+	vector<pair<float, const Clip*>> timeline_entries(timeline.begin(), timeline.end());
+	vector<size_t> creation_order(timeline_entries.size());
+	for(size_t i = 0; i < creation_order.size(); i++)
+		creation_order[i] = i;
+	stable_sort(creation_order.begin(), creation_order.end(), [&timeline_entries](const size_t a, const size_t b){
+		return timeline_entries[a].second->index < timeline_entries[b].second->index;
+	});
+
+	// The start and end time of every clip on each track, so gaps are found by a search rather than a walk of the track
+	vector<map<float, float>> track_clips;
+	vector<int> entry_tracks(timeline_entries.size());
+	for(const size_t i : creation_order){
+		const float start_time = timeline_entries[i].first;
+		const float end_time = start_time + timeline_entries[i].second->length;
+
+		// Check for a track with a gap from the bottom up. If no track has one, create a new one
+		size_t track_index = 0;
+		for(; track_index < track_clips.size(); track_index++){
+			const auto next_clip = track_clips[track_index].lower_bound(start_time);
+			if(next_clip != track_clips[track_index].end()  &&  next_clip->first < end_time)
+				continue;
+			if(next_clip != track_clips[track_index].begin()  &&  prev(next_clip)->second > start_time)
+				continue;
+			break;
+		}
+		if(track_index == track_clips.size())
+			track_clips.emplace_back();
+
+		track_clips[track_index].emplace(start_time, end_time);
+		entry_tracks[i] = track_index;
+	}
+
+	AddPlacementsInOrder(timeline_entries, entry_tracks, track_clips.size(), placements);
+	return track_clips.size();
+}
+
+int KdenliveProject::AllocateTracksMixingOverlaps(const multimap<float, Clip*> &timeline, vector<TrackPlacement> &placements) const{
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AllocateTracksMixingOverlaps");
+
+	// The length and the start of the last clip of both playlists of each track, where 0 is the first playlist and 1 is the second
+	vector<array<float, 2>> playlist_lengths;
+	vector<array<float, 2>> playlist_starts;
+	// Heap entries of a track are only current if its version hasn't changed since they were added
+	vector<unsigned> track_versions;
+	placements.reserve(placements.size() + timeline.size());
+
+	// Sweep through the clips in order of time, like AllocateTracks(). Tracks wait in one heap for the time both of their playlists end,
+	// and in another for the time one playlist has ended and the other ends within the maximum overlap, which is when they can be mixed into
+	typedef tuple<float, int, unsigned> TrackEvent;
+	priority_queue<TrackEvent, vector<TrackEvent>, greater<TrackEvent>> busy_tracks;
+	priority_queue<TrackEvent, vector<TrackEvent>, greater<TrackEvent>> closing_tracks;
+	set<int> free_tracks;
+	set<int> mixable_tracks;
+
+	for(const auto &timeline_entry : timeline){
+		const float entry_start_time = timeline_entry.first;
+		const Clip* clip = timeline_entry.second;
+		const float entry_end_time = entry_start_time + clip->length;
+
+		while(!closing_tracks.empty()  &&  get<0>(closing_tracks.top()) <= entry_start_time){
+			const int track = get<1>(closing_tracks.top());
+			if(get<2>(closing_tracks.top()) == track_versions[track]  &&  max(playlist_lengths[track][0], playlist_lengths[track][1]) > entry_start_time)
+				mixable_tracks.insert(track);
+			closing_tracks.pop();
+		}
+		while(!busy_tracks.empty()  &&  get<0>(busy_tracks.top()) <= entry_start_time){
+			const int track = get<1>(busy_tracks.top());
+			if(get<2>(busy_tracks.top()) == track_versions[track]){
+				free_tracks.insert(track);
+				mixable_tracks.erase(track);
+			}
+			busy_tracks.pop();
+		}
+
+		// Use the lowest availible track. If there is none, mix into the lowest track the clip can be mixed into
+		int track_index = -1;
+		int playlist = 0;
+		float mix_length = 0;
+		if(!free_tracks.empty()){
+			track_index = *free_tracks.begin();
+		}
+		else{
+			for(const int track : mixable_tracks){
+				// The clip goes in whichever playlist has ended, and mixes from the clip still playing in the other
+				const int free_playlist = (playlist_lengths[track][0] <= playlist_lengths[track][1]) ? 0 : 1;
+				const float other_end_time = playlist_lengths[track][1 - free_playlist];
+				if(other_end_time >= entry_end_time  ||  playlist_starts[track][1 - free_playlist] >= entry_start_time)
+					continue;
+				if(free_playlist == 1  &&  clip->sequence != nullptr)
+					continue;
+
+				track_index = track;
+				playlist = free_playlist;
+				mix_length = other_end_time - entry_start_time;
+				break;
+			}
+		}
+		// If there was no availible track, create a new one
+		if(track_index == -1){
+			track_index = playlist_lengths.size();
+			playlist_lengths.push_back( {0, 0} );
+			playlist_starts.push_back( {0, 0} );
+			track_versions.push_back(0);
+		}
+		free_tracks.erase(track_index);
+		mixable_tracks.erase(track_index);
+
+		// Blanks that are too short are not added
+		float &playlist_length = playlist_lengths[track_index][playlist];
+		float blank_length = entry_start_time - playlist_length;
+		if(blank_length > MIN_BLANK_LENGTH)
+			playlist_length += blank_length;
+		else
+			blank_length = 0;
+		playlist_length += clip->length;
+		playlist_starts[track_index][playlist] = entry_start_time;
+
+		const float end_time = max(playlist_lengths[track_index][0], playlist_lengths[track_index][1]);
+		const float mixable_time = max( min(playlist_lengths[track_index][0], playlist_lengths[track_index][1]), end_time - mix_settings.max_overlap_length );
+		track_versions[track_index]++;
+		busy_tracks.emplace(end_time, track_index, track_versions[track_index]);
+		closing_tracks.emplace(mixable_time, track_index, track_versions[track_index]);
+
+		// The second playlist adds its own blanks, at the time of each clip
+		placements.push_back( { track_index, entry_start_time, (playlist == 0) ? blank_length : 0, clip, clip->length, clip->start_offset, clip->fade_in_time, clip->fade_out_time,
+								playlist == 1, mix_length, clip->volume } );
+	}
+
+	return playlist_lengths.size();
+}
+
+int KdenliveProject::AllocateTracksByPriority(const multimap<float, Clip*> &timeline, vector<TrackPlacement> &placements) const{
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AllocateTracksByPriority");
+
+	// Visit the placements from the lowest priority up. The sort is stable, so placements of the same priority stay in order of time
+	vector<pair<float, const Clip*>> timeline_entries(timeline.begin(), timeline.end());
+	vector<size_t> priority_order(timeline_entries.size());
+	for(size_t i = 0; i < priority_order.size(); i++)
+		priority_order[i] = i;
+	stable_sort(priority_order.begin(), priority_order.end(), [&timeline_entries](const size_t a, const size_t b){
+		return timeline_entries[a].second->priority < timeline_entries[b].second->priority;
+	});
+
+	// Split the timeline into spans at every time a clip starts or ends
+	vector<float> span_times;
+	span_times.reserve(2 * timeline_entries.size());
+	for(const auto &timeline_entry : timeline_entries){
+		span_times.push_back(timeline_entry.first);
+		span_times.push_back(timeline_entry.first + timeline_entry.second->length);
+	}
+	sort(span_times.begin(), span_times.end());
+	span_times.erase(unique(span_times.begin(), span_times.end()), span_times.end());
+	TrackHeightTree lower_priority_tracks(span_times.size());
+
+	// Sweep through the clips of each priority in order of time, like AllocateTracks(). Tracks that are still playing a clip
+	// of the same priority wait in a heap ordered by the time they end, and move to the free tracks once that time is reached
+	priority_queue<pair<float, int>, vector<pair<float, int>>, greater<pair<float, int>>> busy_tracks;
+	set<int> free_tracks;
+	int track_count = 0;
+	vector<int> entry_tracks(timeline_entries.size());
+	vector<size_t> span_ranges(2 * timeline_entries.size());
+	size_t priority_start = 0;
+	for(size_t order_index = 0; order_index < priority_order.size(); order_index++){
+		const size_t i = priority_order[order_index];
+		const float start_time = timeline_entries[i].first;
+		const float end_time = start_time + timeline_entries[i].second->length;
+		const int priority = timeline_entries[i].second->priority;
+
+		// At the start of each priority, the clips of the last priority become the ones to go above, and every track is free again
+		if(order_index > 0  &&  priority != timeline_entries[priority_order[order_index - 1]].second->priority){
+			for(; priority_start < order_index; priority_start++){
+				const size_t j = priority_order[priority_start];
+				lower_priority_tracks.TakeTrack(span_ranges[2 * j], span_ranges[2 * j + 1], entry_tracks[j]);
+			}
+			for(; !busy_tracks.empty(); busy_tracks.pop())
+				free_tracks.insert(busy_tracks.top().second);
+		}
+		while(!busy_tracks.empty()  &&  busy_tracks.top().first <= start_time){
+			free_tracks.insert(busy_tracks.top().second);
+			busy_tracks.pop();
+		}
+
+		// The clip goes above every lower priority clip playing at the same time
+		const size_t first_span = lower_bound(span_times.begin(), span_times.end(), start_time) - span_times.begin();
+		const size_t end_span = max(first_span + 1, static_cast<size_t>(lower_bound(span_times.begin(), span_times.end(), end_time) - span_times.begin()));
+		const int min_track = lower_priority_tracks.FindHighestTrack(first_span, end_span) + 1;
+
+		// Use the lowest free track it can go on. If there is none, create new tracks up to the one it needs
+		int track_index;
+		const auto free_track = free_tracks.lower_bound(min_track);
+		if(free_track != free_tracks.end()){
+			track_index = *free_track;
+			free_tracks.erase(free_track);
+		}
+		else{
+			track_index = max(min_track, track_count);
+			for(; track_count < track_index; track_count++)
+				free_tracks.insert(track_count);
+			track_count = track_index + 1;
+		}
+
+		busy_tracks.emplace(end_time, track_index);
+		entry_tracks[i] = track_index;
+		span_ranges[2 * i] = first_span;
+		span_ranges[2 * i + 1] = end_span;
+	}
+
+	AddPlacementsInOrder(timeline_entries, entry_tracks, track_count, placements);
+
+	return track_count;
+}
+
+// Adds the placements in order of time, with the blanks between the clips of each track
+void KdenliveProject::AddPlacementsInOrder(const vector<pair<float, const Clip*>> &timeline_entries, const vector<int> &entry_tracks, const int track_count,
+										   vector<TrackPlacement> &placements) const{
+	vector<float> track_lengths(track_count, 0);
+	placements.reserve(placements.size() + timeline_entries.size());
+	for(size_t i = 0; i < timeline_entries.size(); i++){
+		const float entry_start_time = timeline_entries[i].first;
+		const Clip* clip = timeline_entries[i].second;
+		const int track_index = entry_tracks[i];
+
+		// Blanks that are too short are not added
+		float blank_length = entry_start_time - track_lengths[track_index];
+		if(blank_length > MIN_BLANK_LENGTH)
+			track_lengths[track_index] += blank_length;
+		else
+			blank_length = 0;
+		track_lengths[track_index] += clip->length;
+
+		placements.push_back( { track_index, entry_start_time, blank_length, clip, clip->length, clip->start_offset, clip->fade_in_time, clip->fade_out_time, false, 0, clip->volume } );
+	}
+}
+
+void KdenliveProject::AddClipsToBin(KdenliveFile* kdenlive_file, const vector<string> &media_folder_paths, map<string, ClipId> &bin_ids, const size_t first_clip_index){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::ResolveMediaPaths");
+
+	for(size_t i = first_clip_index; i < clips.size(); i++){
+		const Clip &clip = clips[i];
+
+		// Sequences have no media, and are added to the bin by AddSequencesToFile()
+		if(clip.sequence != nullptr)
+			continue;
+
+		// Check if the clip has not been to the file
+		if(bin_ids.find(clip.name) == bin_ids.end()){
+			// Find the filepath to use for this clip
+			const string &filepath = ResolveMediaPath(media_folder_paths, clip.name);
+			// Add the clip the the KdenliveFile bin
+			ClipId clip_id = kdenlive_file->AddClipToBin(filepath);
+			
+			// Add clip_id to bin_ids map
+			bin_ids.insert( {clip.name, clip_id} );
+		}
+	}
+}
+
+string KdenliveProject::FindProxyPath(const vector<string> &media_folder_paths, const string &name, const bool use_proxy){
+	// Fill in the pattern
+	string proxy_path = proxy_settings.path_pattern;
+	for(size_t name_pos = proxy_path.find("{name}"); name_pos != string::npos; name_pos = proxy_path.find("{name}", name_pos + name.size()))
+		proxy_path.replace(name_pos, strlen("{name}"), name);
+
+	if(proxy_path.empty()  ||  use_proxy)
+		return proxy_path;
+
+	// Link proxies that were already rendered. Kdenlive finds relative paths from the folder of the project, rather than the working directory
+	error_code error;
+	if( fs::exists(fs::path(project_folder_path) / proxy_path, error) )
+		return proxy_path;
+
+	// Give a proxy to media that is too large to edit smoothly
+	if(proxy_settings.min_file_size > 0){
+		const uintmax_t file_size = fs::file_size(ResolveMediaPath(media_folder_paths, name), error);
+		if(!error  &&  file_size >= proxy_settings.min_file_size)
+			return proxy_path;
+	}
+
+	return "";
+}
+
+void KdenliveProject::AddProxiesToBin(KdenliveFile* kdenlive_file, const vector<string> &media_folder_paths, const map<string, ClipId> &bin_ids){
+	if(!proxy_settings.is_enabled)
+		return;
+
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AddProxiesToBin");
+
+	// Document settings
+	kdenlive_file->SetBinProperty("kdenlive:docproperties.enableproxy", "1");
+	kdenlive_file->SetBinProperty("kdenlive:docproperties.generateproxy", "1");
+	kdenlive_file->SetBinProperty("kdenlive:docproperties.proxyminsize", to_string(proxy_settings.min_frame_width).c_str());
+	kdenlive_file->SetBinProperty("kdenlive:docproperties.proxyextension", proxy_settings.extension.c_str());
+	if(!proxy_settings.params.empty())
+		kdenlive_file->SetBinProperty("kdenlive:docproperties.proxyparams", proxy_settings.params.c_str());
+
+	// A proxy belongs to the media, so it is used if any clip with that name uses one
+	set<string> proxy_names;
+	for(const Clip &clip : clips){
+		if(clip.use_proxy)
+			proxy_names.insert(clip.name);
+	}
+
+	for(const auto &bin_id : bin_ids)
+		kdenlive_file->SetClipProxy( bin_id.second, FindProxyPath(media_folder_paths, bin_id.first, proxy_names.count(bin_id.first) > 0) );
+}
+
+void KdenliveProject::AddPreviewChunksToTimeline(KdenliveFile* kdenlive_file) const{
+	if(!preview_settings.extension.empty())
+		kdenlive_file->SetBinProperty("kdenlive:docproperties.previewextension", preview_settings.extension.c_str());
+	if(!preview_settings.parameters.empty())
+		kdenlive_file->SetBinProperty("kdenlive:docproperties.previewparameters", preview_settings.parameters.c_str());
+
+	if(preview_settings.min_stacked_video_clips <= 0  &&  !preview_settings.include_fades  &&  preview_settings.ranges.empty())
+		return;
+
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AddPreviewChunksToTimeline");
+
+	// List the first frame of every chunk that overlaps a range. The ranges are in order, so the chunks are too
+	const int file_framerate = getFileFramerate(framerate);
+	string chunks;
+	int next_chunk = 0;
+	for(const PreviewRange &range : ComputePreviewRanges()){
+		const int first_chunk = max(next_chunk, static_cast<int>( floorf(range.start_time * file_framerate) ) / PREVIEW_CHUNK_FRAME_COUNT);
+		const int last_chunk = ( static_cast<int>( ceilf(range.end_time * file_framerate) ) - 1 ) / PREVIEW_CHUNK_FRAME_COUNT;
+
+		for(int chunk = first_chunk; chunk <= last_chunk; chunk++){
+			if(!chunks.empty())
+				chunks += ",";
+			chunks += to_string(chunk * PREVIEW_CHUNK_FRAME_COUNT);
+		}
+		next_chunk = max(next_chunk, last_chunk + 1);
+	}
+
+	// Kdenlive renders dirty chunks when timeline preview is started
+	kdenlive_file->SetTimelineProperty("kdenlive:sequenceproperties.dirtypreviewchunks", chunks.empty() ? nullptr : chunks.c_str());
+}
+
+void KdenliveProject::AddMarkersToFile(KdenliveFile* kdenlive_file, const map<string, ClipId> &bin_ids, const size_t first_guide_index) const{
+	if(first_guide_index < guides.size())
+		kdenlive_file->AddGuides(guides.data() + first_guide_index, guides.size() - first_guide_index);
+
+	if(marked_clip_count == 0)
+		return;
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AddMarkersToFile");
+
+	// Sequences have no media to mark
+	for(const Clip &clip : clips){
+		if(!clip.markers.empty()  &&  clip.sequence == nullptr)
+			kdenlive_file->AddClipMarkers(bin_ids.at(clip.name), clip.markers);
+	}
+}
+
+void KdenliveProject::AddPlacementToTrack(KdenliveFile* kdenlive_file, const TrackId track_id, const TrackPlacement &placement,
+										   const map<string, ClipId> &bin_ids, const map<const KdenliveProject*, SequenceId> &sequence_ids, GenerationStats* stats,
+										   const vector<VolumeKeyframe>* duck_keyframes) const{
+	// Fill the space between the end of the track and the clip
+	if(placement.blank_length > 0)
+		kdenlive_file->AddBlankToTrack(track_id, placement.blank_length);
+
+	int mix_clip_index = -1;
+	TrackEntryId entry_id = -1;
+	if(placement.is_in_mix_playlist){
+		const ClipId clip_id = bin_ids.at(placement.clip->name);
+		mix_clip_index = kdenlive_file->AddClipToMixPlaylist(track_id, clip_id, placement.time_stamp, placement.length, placement.start_offset);
+		kdenlive_file->FadeMixClip(track_id, mix_clip_index, placement.fade_in_time, placement.fade_out_time);
+	}
+	else{
+		if(placement.clip->sequence != nullptr){
+			entry_id = kdenlive_file->AddSequenceToTrack(track_id, sequence_ids.at(placement.clip->sequence), placement.length, placement.start_offset);
+		}
+		else{
+			const ClipId clip_id = bin_ids.at(placement.clip->name);
+			entry_id = kdenlive_file->AddClipToTrack(track_id, clip_id, placement.length, placement.start_offset);
+		}
+		kdenlive_file->FadeClip(track_id, entry_id, placement.fade_in_time, placement.fade_out_time);
+	}
+
+	// Volume only changes clips on audio tracks. Ducked music already includes the volume of the clip
+	const bool is_ducked = duck_keyframes != nullptr  &&  !duck_keyframes->empty();
+	const vector<VolumeKeyframe> &keyframes = is_ducked ? *duck_keyframes : placement.clip->volume_keyframes;
+	const bool has_volume = (kdenlive_file->GetTrackType(track_id) == KdenliveFile::AUDIO)  &&  (!keyframes.empty()  ||  placement.volume != 0);
+	if(has_volume){
+		if(placement.is_in_mix_playlist){
+			if(!keyframes.empty())
+				kdenlive_file->SetMixClipVolume(track_id, mix_clip_index, keyframes);
+			else
+				kdenlive_file->SetMixClipVolume(track_id, mix_clip_index, { {0, placement.volume} });
+		}
+		else{
+			if(!keyframes.empty())
+				kdenlive_file->SetEntryVolume(track_id, entry_id, keyframes);
+			else
+				kdenlive_file->SetEntryVolume(track_id, entry_id, placement.volume);
+		}
+	}
+
+	// The mix goes from the clip in the other playlist to this one
+	const bool has_mix = placement.mix_length > 0  &&  mix_settings.has_transitions;
+	if(has_mix)
+		kdenlive_file->AddMixTransition(track_id, placement.time_stamp, placement.mix_length, !placement.is_in_mix_playlist);
+
+	if(stats != nullptr){
+		stats->clips_placed++;
+		stats->blanks_emitted += (placement.blank_length > 0);
+		stats->filters_emitted += (placement.fade_in_time > 0) + (placement.fade_out_time > 0) + has_volume;
+		stats->transitions_emitted += has_mix;
+	}
+}
+
+void KdenliveProject::AddCrossfades(KdenliveFile* kdenlive_file, const TrackId first_track_id, const vector<TrackPlacement> &placements, GenerationStats* stats) const{
+	if(!is_crossfading)
+		return;
+	KDENCODE_TRACE_SCOPE("KdenliveProject::AddCrossfades");
+
+	// Sweep through the placements in order of time. The clips still playing that haven't crossfaded into another clip yet
+	// are kept in order of the time they end, so the clip each placement crossfades from is found in O(log n)
+	set<pair<float, size_t>> fading_clips;
+	for(size_t i = 0; i < placements.size(); i++){
+		const TrackPlacement &placement = placements[i];
+		const float start_time = placement.time_stamp;
+		const float end_time = start_time + placement.length;
+
+		while(!fading_clips.empty()  &&  fading_clips.begin()->first <= start_time)
+			fading_clips.erase(fading_clips.begin());
+
+		// Crossfade from the last clip to end before this one does, that started before it on another track
+		auto fading_clip = fading_clips.lower_bound( {end_time, 0} );
+		while(fading_clip != fading_clips.begin()){
+			fading_clip--;
+			const TrackPlacement &previous = placements[fading_clip->second];
+			if(previous.track_index == placement.track_index  ||  previous.time_stamp >= start_time)
+				continue;
+
+			kdenlive_file->AddCrossfade(first_track_id + previous.track_index, first_track_id + placement.track_index, start_time, fading_clip->first - start_time);
+			if(stats != nullptr)
+				stats->transitions_emitted++;
+			fading_clips.erase(fading_clip);
+			break;
+		}
+
+		fading_clips.emplace(end_time, i);
+	}
+}
+
+void KdenliveProject::ComputeDuckKeyframes(const vector<TrackPlacement> &placements, vector<vector<VolumeKeyframe>> &duck_keyframes) const{
+	duck_keyframes.clear();
+	if(!ducking_settings.is_enabled)
+		return;
+	KDENCODE_TRACE_SCOPE("KdenliveProject::ComputeDuckKeyframes");
+
+	duck_keyframes.resize(placements.size());
+
+	// The placements are already in order of time, unless gaps were filled
+	vector<size_t> dialog_order;
+	vector<size_t> music_order;
+	for(size_t i = 0; i < placements.size(); i++){
+		const Clip* clip = placements[i].clip;
+		if(clip->audio_role == Clip::DIALOG)
+			dialog_order.push_back(i);
+		else if(clip->audio_role == Clip::MUSIC  &&  clip->volume_keyframes.empty())
+			music_order.push_back(i);
+	}
+	const auto is_earlier = [&placements](const size_t a, const size_t b){
+		return placements[a].time_stamp < placements[b].time_stamp;
+	};
+	for(vector<size_t>* order : { &dialog_order, &music_order }){
+		if(!is_sorted(order->begin(), order->end(), is_earlier))
+			stable_sort(order->begin(), order->end(), is_earlier);
+	}
+
+	// A fade shorter than a frame would put both of its keyframes on the same frame
+	const float fade_time = max( ducking_settings.fade_time, 1.0f / getFileFramerate(framerate) );
+	const float duck_volume = ducking_settings.volume;
+
+	// Join the dialog into ranges, where dialog that starts before the music could fade back up from the last range joins it
+	vector<pair<float, float>> duck_ranges;
+	for(const size_t i : dialog_order){
+		const float start_time = placements[i].time_stamp;
+		const float end_time = start_time + placements[i].length;
+		if(!duck_ranges.empty()  &&  start_time - fade_time <= duck_ranges.back().second + fade_time)
+			duck_ranges.back().second = max(duck_ranges.back().second, end_time);
+		else
+			duck_ranges.emplace_back(start_time, end_time);
+	}
+
+	// Sweep through the music and the ranges together. Both are in order of time, so the first range that is still fading
+	// when each music clip starts only ever moves forward
+	size_t first_range = 0;
+	for(const size_t i : music_order){
+		const TrackPlacement &placement = placements[i];
+		const float start_time = placement.time_stamp;
+		const float end_time = start_time + placement.length;
+		while(first_range < duck_ranges.size()  &&  duck_ranges[first_range].second + fade_time <= start_time)
+			first_range++;
+
+		// No dialog plays during the music
+		if(first_range == duck_ranges.size()  ||  duck_ranges[first_range].first - fade_time >= end_time)
+			continue;
+
+		// Keyframe the start and end of the music, and each end of each fade between them
+		vector<VolumeKeyframe> &keyframes = duck_keyframes[i];
+		keyframes.push_back( {0, placement.volume + getDuckVolume(duck_ranges[first_range], duck_volume, fade_time, start_time)} );
+		size_t range = first_range;
+		for(; range < duck_ranges.size()  &&  duck_ranges[range].first - fade_time < end_time; range++){
+			const float fade_times[4] = { duck_ranges[range].first - fade_time, duck_ranges[range].first, duck_ranges[range].second, duck_ranges[range].second + fade_time };
+			const float fade_volumes[4] = { 0, duck_volume, duck_volume, 0 };
+			for(int j = 0; j < 4; j++){
+				if(fade_times[j] > start_time  &&  fade_times[j] < end_time)
+					keyframes.push_back( {fade_times[j] - start_time, placement.volume + fade_volumes[j]} );
+			}
+		}
+		keyframes.push_back( {placement.length, placement.volume + getDuckVolume(duck_ranges[range - 1], duck_volume, fade_time, end_time)} );
+	}
+}
+
+void KdenliveProject::AddSequencesToFile(KdenliveFile* kdenlive_file, const vector<string> &media_folder_paths,
+										  map<string, ClipId> &bin_ids, map<const KdenliveProject*, SequenceId> &sequence_ids, GenerationStats* stats){
+	if(sequence_clip_count == 0)
+		return;
+
+	// Each project is written once, however many clips play it
+	for(const Clip &clip : clips){
+		if(clip.sequence != nullptr  &&  sequence_ids.find(clip.sequence) == sequence_ids.end())
+			clip.sequence->BuildSequence(kdenlive_file, media_folder_paths, clip.name, bin_ids, sequence_ids, stats);
+	}
+}
+
+SequenceId KdenliveProject::BuildSequence(KdenliveFile* kdenlive_file, const vector<string> &media_folder_paths, const string &name,
+										  map<string, ClipId> &bin_ids, map<const KdenliveProject*, SequenceId> &sequence_ids, GenerationStats* stats){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::BuildSequence");
+
+	// The sequences placed in this one must be in the file before it
+	AddSequencesToFile(kdenlive_file, media_folder_paths, bin_ids, sequence_ids, stats);
+	AddClipsToBin(kdenlive_file, media_folder_paths, bin_ids, 0);
+
+	// Assign every clip to a track of the sequence
+	vector<TrackPlacement> video_placements;
+	vector<TrackPlacement> audio_placements;
+	const int video_track_count = AllocateTracks(video_timeline, video_placements, true);
+	const int audio_track_count = AllocateTracks(audio_timeline, audio_placements, false);
+
+	// Add the tracks after every track already in the file
+	const SequenceId sequence_id = kdenlive_file->AddSequence(name);
+	const TrackId first_track_id = kdenlive_file->GetTrackCount();
+	for(int i = 0; i < video_track_count; i++)
+		kdenlive_file->AddTrack(KdenliveFile::VIDEO, sequence_id);
+	for(int i = 0; i < audio_track_count; i++)
+		kdenlive_file->AddTrack(KdenliveFile::AUDIO, sequence_id);
+
+	for(const TrackPlacement &placement : video_placements)
+		AddPlacementToTrack(kdenlive_file, first_track_id + placement.track_index, placement, bin_ids, sequence_ids, stats);
+	vector<vector<VolumeKeyframe>> duck_keyframes;
+	ComputeDuckKeyframes(audio_placements, duck_keyframes);
+	for(size_t i = 0; i < audio_placements.size(); i++){
+		AddPlacementToTrack(kdenlive_file, first_track_id + video_track_count + audio_placements[i].track_index, audio_placements[i], bin_ids, sequence_ids, stats,
+							duck_keyframes.empty() ? nullptr : &duck_keyframes[i]);
+	}
+	AddCrossfades(kdenlive_file, first_track_id, video_placements, stats);
+	AddCrossfades(kdenlive_file, first_track_id + video_track_count, audio_placements, stats);
+
+	if(stats != nullptr)
+		stats->tracks_created += video_track_count + audio_track_count;
+
+	sequence_ids.insert( {this, sequence_id} );
+	return sequence_id;
+}
+
+KdenliveFile* KdenliveProject::BuildFile(const vector<string> &media_folder_paths, 
+										 const vector<TrackPlacement> &video_placements, const int video_track_count,
+										 const vector<TrackPlacement> &audio_placements, const int audio_track_count,
+										 map<string, ClipId> &bin_ids, GenerationStats* stats){
+	PhaseTimer build_timer(stats, &GenerationStats::build_seconds);
+
+	KdenliveFile* kdenlive_file = new KdenliveFile;
+	
+	// Start the document
+	kdenlive_file->SetProfile(framerate, frame_width, frame_height);
+	
+	// Add all filepaths to the KdenliveFile file
+	const double previous_resolve_seconds = (stats != nullptr) ? stats->resolve_seconds : 0;
+	{
+	PhaseTimer resolve_timer(stats, &GenerationStats::resolve_seconds);
+	AddClipsToBin(kdenlive_file, media_folder_paths, bin_ids, 0);
+	AddProxiesToBin(kdenlive_file, media_folder_paths, bin_ids);
+	}
+
+	// Add the tracks. Video tracks come first, and audio tracks after them
+	for(int i = 0; i < video_track_count; i++)
+		kdenlive_file->AddTrack(KdenliveFile::VIDEO);
+	for(int i = 0; i < audio_track_count; i++)
+		kdenlive_file->AddTrack(KdenliveFile::AUDIO);
+
+	// Sequences must be complete before they are placed
+	map<const KdenliveProject*, SequenceId> sequence_ids;
+	AddSequencesToFile(kdenlive_file, media_folder_paths, bin_ids, sequence_ids, stats);
+
+	// Add the clips in the order they appear on the timeline
+	{
+	KDENCODE_TRACE_SCOPE("KdenliveProject::PlaceClips");
+	for(const TrackPlacement &placement : video_placements)
+		AddPlacementToTrack(kdenlive_file, placement.track_index, placement, bin_ids, sequence_ids, stats);
+	vector<vector<VolumeKeyframe>> duck_keyframes;
+	ComputeDuckKeyframes(audio_placements, duck_keyframes);
+	for(size_t i = 0; i < audio_placements.size(); i++){
+		AddPlacementToTrack(kdenlive_file, video_track_count + audio_placements[i].track_index, audio_placements[i], bin_ids, sequence_ids, stats,
+							duck_keyframes.empty() ? nullptr : &duck_keyframes[i]);
+	}
+	}
+	AddCrossfades(kdenlive_file, 0, video_placements, stats);
+	AddCrossfades(kdenlive_file, video_track_count, audio_placements, stats);
+	AddPreviewChunksToTimeline(kdenlive_file);
+	AddMarkersToFile(kdenlive_file, bin_ids, 0);
+
+	if(stats != nullptr){
+		stats->tracks_created += video_track_count + audio_track_count;
+		// Resolving is timed on its own, so don't count it twice
+		stats->build_seconds -= stats->resolve_seconds - previous_resolve_seconds;
+	}
+	
+	return kdenlive_file;
+}
+
+KdenliveFile* KdenliveProject::GenerateFile(const vector<string> &media_folder_paths, GenerationStats* stats){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::GenerateFile");
+
+	// Files may have been moved since the last save
+	ClearResolvedPaths();
+	project_folder_path.clear();
+
+	if(stats != nullptr)
+		*stats = GenerationStats();
+
+	KdenliveFile* file = GenerateNewFile(media_folder_paths, stats);
+
+	if(stats != nullptr)
+		stats->xml_nodes = file->CountNodes();
+
+	return file;
+}
+
+KdenliveFile* KdenliveProject::GenerateNewFile(const vector<string> &media_folder_paths, GenerationStats* stats){
+	// Assign every clip to a track
+	vector<TrackPlacement> video_placements;
+	vector<TrackPlacement> audio_placements;
+	int video_track_count, audio_track_count;
+	{
+	PhaseTimer allocate_timer(stats, &GenerationStats::allocate_seconds);
+	video_track_count = AllocateTracks(video_timeline, video_placements, true);
+	audio_track_count = AllocateTracks(audio_timeline, audio_placements, false);
+	}
+
+	map<string, ClipId> bin_ids;
+	return BuildFile(media_folder_paths, video_placements, video_track_count, audio_placements, audio_track_count, bin_ids, stats);
+}
+
+KdenliveFile* KdenliveProject::UpdateGeneratedFile(const vector<string> &media_folder_paths, GenerationStats* stats){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::UpdateGeneratedFile");
+
+	const bool has_same_settings = generated_file != nullptr
+		&& media_folder_paths == generated_media_folder_paths
+		&& framerate == generated_framerate  &&  frame_width == generated_frame_width  &&  frame_height == generated_frame_height
+		&& proxy_settings == generated_proxy_settings  &&  preview_settings == generated_preview_settings
+		&& is_filling_gaps == generated_is_filling_gaps  &&  mix_settings == generated_mix_settings  &&  is_crossfading == generated_is_crossfading
+		&& ducking_settings == generated_ducking_settings
+		// Sequence projects may have changed without this project knowing, and keyframes and markers may have changed without a placement changing
+		&& sequence_clip_count == 0  &&  keyframed_clip_count == 0  &&  marked_clip_count == 0
+		// Tracks are only rebuilt in their first playlist, transitions between tracks aren't rebuilt,
+		// and dialog changes the volume of music on other tracks
+		&& mix_settings.max_overlap_length <= 0  &&  !is_crossfading  &&  !ducking_settings.is_enabled;
+
+	// Nothing has changed since the last generation
+	if(has_same_settings  &&  change_count == generated_change_count)
+		return generated_file;
+
+	// Assign every clip to a track, and group the placements by TrackId
+	vector<TrackPlacement> video_placements;
+	vector<TrackPlacement> audio_placements;
+	int video_track_count, audio_track_count;
+	vector<vector<TrackPlacement>> tracks;
+	{
+	PhaseTimer allocate_timer(stats, &GenerationStats::allocate_seconds);
+	video_track_count = AllocateTracks(video_timeline, video_placements, true);
+	audio_track_count = AllocateTracks(audio_timeline, audio_placements, false);
+
+	tracks.resize(video_track_count + audio_track_count);
+	for(const TrackPlacement &placement : video_placements)
+		tracks[placement.track_index].push_back(placement);
+	for(const TrackPlacement &placement : audio_placements)
+		tracks[video_track_count + placement.track_index].push_back(placement);
+	}
+
+	if(!has_same_settings  ||  video_track_count != generated_video_track_count  ||  tracks.size() != generated_tracks.size()){
+		// Rebuild the entire file
+		delete generated_file;
+		generated_bin_ids.clear();
+		generated_file = BuildFile(media_folder_paths, video_placements, video_track_count, audio_placements, audio_track_count, generated_bin_ids, stats);
+	}
+	else{
+		// Only clips created since the last generation can have new names
+		{
+		PhaseTimer resolve_timer(stats, &GenerationStats::resolve_seconds);
+		AddClipsToBin(generated_file, media_folder_paths, generated_bin_ids, generated_clip_count);
+		// Any clip may have been marked to use a proxy since then
+		AddProxiesToBin(generated_file, media_folder_paths, generated_bin_ids);
+		}
+
+		// Rebuild each track from its first changed placement onward
+		PhaseTimer build_timer(stats, &GenerationStats::build_seconds);
+		bool is_track_rebuilt = false;
+		for(size_t track_id = 0; track_id < tracks.size(); track_id++){
+			const vector<TrackPlacement> &placements = tracks[track_id];
+			const vector<TrackPlacement> &previous_placements = generated_tracks[track_id];
+
+			// Find the first changed placement, and the entry it starts at
+			size_t first_changed = 0;
+			TrackEntryId first_changed_entry = 0;
+			while(first_changed < placements.size()  &&  first_changed < previous_placements.size()  &&  placements[first_changed] == previous_placements[first_changed]){
+				first_changed_entry += (placements[first_changed].blank_length > 0) ? 2 : 1;
+				first_changed++;
+			}
+
+			// The track is unchanged
+			if(first_changed == placements.size()  &&  first_changed == previous_placements.size())
+				continue;
+
+			generated_file->TruncateTrack(track_id, first_changed_entry);
+			for(size_t i = first_changed; i < placements.size(); i++)
+				AddPlacementToTrack(generated_file, track_id, placements[i], generated_bin_ids, {}, stats);
+			is_track_rebuilt = true;
+		}
+
+		// Filters are numbered in the order BuildFile() adds the clips, which the rebuilt tracks no longer follow
+		if(is_track_rebuilt  &&  generated_file->GetFilterCount() > 0){
+			vector<TrackId> clip_track_order;
+			clip_track_order.reserve(video_placements.size() + audio_placements.size());
+			for(const TrackPlacement &placement : video_placements)
+				clip_track_order.push_back(placement.track_index);
+			for(const TrackPlacement &placement : audio_placements)
+				clip_track_order.push_back(video_track_count + placement.track_index);
+			generated_file->RenumberFilters(clip_track_order);
+		}
+
+		// Any change to the timeline can change what should be pre-rendered
+		AddPreviewChunksToTimeline(generated_file);
+		// Guides are only ever added after the ones already in the file
+		AddMarkersToFile(generated_file, generated_bin_ids, generated_guide_count);
+	}
+
+	// Remember what was generated
+	generated_change_count = change_count;
+	generated_clip_count = clips.size();
+	generated_guide_count = guides.size();
+	generated_media_folder_paths = media_folder_paths;
+	generated_framerate = framerate;
+	generated_frame_width = frame_width;
+	generated_frame_height = frame_height;
+	generated_proxy_settings = proxy_settings;
+	generated_preview_settings = preview_settings;
+	generated_mix_settings = mix_settings;
+	generated_is_crossfading = is_crossfading;
+	generated_ducking_settings = ducking_settings;
+	generated_is_filling_gaps = is_filling_gaps;
+	generated_video_track_count = video_track_count;
+	generated_tracks = move(tracks);
+
+	return generated_file;
+}
+
+string KdenliveProject::SaveAsString(const vector<string> &media_folder_paths, GenerationStats* stats){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::SaveAsString");
+
+	// Files may have been moved since the last save
+	ClearResolvedPaths();
+	project_folder_path.clear();
+
+	if(stats != nullptr)
+		*stats = GenerationStats();
+
+	// Generate the file. Incremental generation keeps the file for the next save
+	KdenliveFile* file = is_incremental ? UpdateGeneratedFile(media_folder_paths, stats) : GenerateNewFile(media_folder_paths, stats);
+
+	if(is_incremental)
+		file->SetBinProperty(PROJECT_HASH_PROPERTY, nullptr);
+
+	string file_str;
+	{
+	PhaseTimer print_timer(stats, &GenerationStats::print_seconds);
+	file_str = file->ToString();
+	}
+
+	if(stats != nullptr){
+		stats->xml_nodes = file->CountNodes();
+		stats->bytes_written = file_str.size();
+	}
+
+	// Deallocate the file
+	if(!is_incremental)
+		delete file;
+
+	return file_str;
+}
+
+bool KdenliveProject::SaveToFile(const vector<string> &media_folder_paths, const string &file_name, const string &output_filepath, const bool skip_if_unchanged, GenerationStats* stats){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::SaveToFile");
+
+	// Files may have been moved since the last save
+	ClearResolvedPaths();
+	project_folder_path = output_filepath;
+
+	if(stats != nullptr)
+		*stats = GenerationStats();
+
+	const string file_path = getOutputFilePath(file_name, output_filepath);
+
+	// Check if the existing file was generated from the same project
+	string project_hash;
+	if(skip_if_unchanged){
+		{
+		PhaseTimer resolve_timer(stats, &GenerationStats::resolve_seconds);
+		map<const KdenliveProject*, uint64_t> sequence_hashes;
+		project_hash = convertHashToString( HashModel(media_folder_paths, sequence_hashes) );
+		}
+
+		if(readProjectHash(file_path) == project_hash)
+			return false;
+	}
+
+	// Generate the file. Incremental generation keeps the file for the next save
+	KdenliveFile* file = is_incremental ? UpdateGeneratedFile(media_folder_paths, stats) : GenerateNewFile(media_folder_paths, stats);
+	
+	file->SetBinProperty(PROJECT_HASH_PROPERTY, skip_if_unchanged ? project_hash.c_str() : nullptr);
+
+	string file_str;
+	{
+	PhaseTimer print_timer(stats, &GenerationStats::print_seconds);
+	file_str = file->ToString();
+	}
+	{
+	PhaseTimer write_timer(stats, &GenerationStats::write_seconds);
+	ofstream output = openOutputFile(file_path);
+	output << file_str;
+	output.close();
+	}
+
+	if(stats != nullptr){
+		stats->xml_nodes = file->CountNodes();
+		stats->bytes_written = file_str.size();
+	}
+
+	// Deallocate the file
+	if(!is_incremental)
+		delete file;
+
+	return true;
+}
+
+uint64_t KdenliveProject::ComputeHash(const vector<string> &media_folder_paths){
+	// Files may have been moved since the last hash
+	ClearResolvedPaths();
+	project_folder_path.clear();
+
+	map<const KdenliveProject*, uint64_t> sequence_hashes;
+	return HashModel(media_folder_paths, sequence_hashes);
+}
+
+
+// RENDERING
+vector<PreviewRange> KdenliveProject::ComputePreviewRanges() const{
+	vector<PreviewRange> ranges = preview_settings.ranges;
+
+	// Sweep the video timeline for ranges where enough clips are stacked
+	if(preview_settings.min_stacked_video_clips > 0){
+		vector<pair<float, int>> events;	// The time of each clip starting (1) or ending (-1)
+		events.reserve(2 * video_timeline.size());
+		for(const auto &timeline_entry : video_timeline){
+			events.push_back( { timeline_entry.first, 1 } );
+			events.push_back( { timeline_entry.first + timeline_entry.second->length, -1 } );
+		}
+		// Clips that end at the same time another starts are not stacked
+		sort(events.begin(), events.end());
+
+		int playing_count = 0;
+		float stack_start = 0;
+		for(const pair<float, int> &event : events){
+			const int previous_count = playing_count;
+			playing_count += event.second;
+
+			if(previous_count < preview_settings.min_stacked_video_clips  &&  playing_count >= preview_settings.min_stacked_video_clips)
+				stack_start = event.first;
+			else if(previous_count >= preview_settings.min_stacked_video_clips  &&  playing_count < preview_settings.min_stacked_video_clips  &&  event.first > stack_start)
+				ranges.push_back( { stack_start, event.first } );
+		}
+	}
+
+	if(preview_settings.include_fades){
+		for(const auto &timeline_entry : video_timeline){
+			const Clip* clip = timeline_entry.second;
+			if(clip->fade_in_time > 0)
+				ranges.push_back( { timeline_entry.first, timeline_entry.first + clip->fade_in_time } );
+			if(clip->fade_out_time > 0)
+				ranges.push_back( { timeline_entry.first + clip->length - clip->fade_out_time, timeline_entry.first + clip->length } );
+		}
+	}
+
+	// Merge the ranges that overlap or touch
+	sort(ranges.begin(), ranges.end(), [](const PreviewRange &a, const PreviewRange &b){
+		return a.start_time < b.start_time;
+	});
+	vector<PreviewRange> merged_ranges;
+	for(const PreviewRange &range : ranges){
+		if(range.end_time <= range.start_time)
+			continue;
+
+		if(!merged_ranges.empty()  &&  range.start_time <= merged_ranges.back().end_time)
+			merged_ranges.back().end_time = max(merged_ranges.back().end_time, range.end_time);
+		else
+			merged_ranges.push_back(range);
+	}
+
+	return merged_ranges;
+}
+
+vector<RenderZone> KdenliveProject::ComputeRenderZones(const int zone_count, const float max_uncut_clip_length) const{
+	KDENCODE_TRACE_SCOPE("KdenliveProject::ComputeRenderZones");
+
+	// Every clip starting or ending, on both timelines
+	struct ZoneEvent{
+		float time;
+		int change;		// 1 when a clip starts, -1 when it ends
+		bool is_short;	// The clip can't be cut
+	};
+	vector<ZoneEvent> events;
+	events.reserve( 2 * (video_timeline.size() + audio_timeline.size()) );
+	float timeline_end = 0;
+	for(const auto &timeline : { &video_timeline, &audio_timeline }){
+		for(const auto &timeline_entry : *timeline){
+			const float length = timeline_entry.second->length;
+			const bool is_short = length <= max_uncut_clip_length;
+			events.push_back( { timeline_entry.first, 1, is_short } );
+			events.push_back( { timeline_entry.first + length, -1, is_short } );
+			timeline_end = max(timeline_end, timeline_entry.first + length);
+		}
+	}
+	if(events.empty()  ||  zone_count < 1  ||  timeline_end <= 0)
+		return {};
+
+	// Clips that end at the same time another starts are not both playing then
+	sort(events.begin(), events.end(), [](const ZoneEvent &a, const ZoneEvent &b){
+		return a.time < b.time  ||  (a.time == b.time  &&  a.change < b.change);
+	});
+
+	// Sweep the timeline once, splitting it into segments where the same clips are playing.
+	// Every moment costs 1 to render, plus 1 for each clip playing
+	struct ZoneSegment{
+		float start_time;
+		float end_time;
+		double cost_rate;
+		bool has_short_clip;
+	};
+	vector<ZoneSegment> segments;
+	vector<float> cut_times = { 0 };	// Times between segments that don't cut through a short clip
+	double total_cost = 0;
+	int playing_count = 0;
+	int short_playing_count = 0;
+	float segment_start = 0;
+
+	for(size_t i = 0; i < events.size(); ){
+		const float time = events[i].time;
+		if(time > segment_start){
+			segments.push_back( { segment_start, time, 1.0 + playing_count, short_playing_count > 0 } );
+			total_cost += (time - segment_start) * (1.0 + playing_count);
+			segment_start = time;
+		}
+
+		// Clips ending here aren't cut, and neither are clips starting here
+		for(; i < events.size()  &&  events[i].time == time  &&  events[i].change < 0; i++){
+			playing_count--;
+			short_playing_count -= events[i].is_short;
+		}
+		if(short_playing_count == 0)
+			cut_times.push_back(time);
+		for(; i < events.size()  &&  events[i].time == time; i++){
+			playing_count++;
+			short_playing_count += events[i].is_short;
+		}
+	}
+
+	// Place each boundary where the cost before it reaches its share of the total
+	const int file_framerate = getFileFramerate(framerate);
+	vector<float> boundaries = { 0 };
+	size_t segment_index = 0;
+	double segment_start_cost = 0;
+
+	for(int zone = 1; zone < zone_count; zone++){
+		const double target_cost = total_cost * zone / zone_count;
+		while(segment_index + 1 < segments.size()  &&
+			  segment_start_cost + (segments[segment_index].end_time - segments[segment_index].start_time) * segments[segment_index].cost_rate < target_cost){
+			segment_start_cost += (segments[segment_index].end_time - segments[segment_index].start_time) * segments[segment_index].cost_rate;
+			segment_index++;
+		}
+		const ZoneSegment &segment = segments[segment_index];
+		float boundary = segment.start_time + static_cast<float>( (target_cost - segment_start_cost) / segment.cost_rate );
+
+		// Move the boundary out of any short clip, to the closest time that doesn't cut one
+		if(segment.has_short_clip){
+			const auto next_cut = lower_bound(cut_times.begin(), cut_times.end(), boundary);
+			const float next_cut_time = (next_cut != cut_times.end()) ? *next_cut : timeline_end;
+			const float previous_cut_time = (next_cut != cut_times.begin()) ? *prev(next_cut) : 0;
+			boundary = (boundary - previous_cut_time <= next_cut_time - boundary) ? previous_cut_time : next_cut_time;
+		}
+
+		// Zones are rendered in whole frames
+		boundary = roundf(boundary * file_framerate) / file_framerate;
+		if(boundary > boundaries.back()  &&  boundary < timeline_end)
+			boundaries.push_back(boundary);
+	}
+	boundaries.push_back(timeline_end);
+
+	vector<RenderZone> zones;
+	for(size_t i = 0; i + 1 < boundaries.size(); i++)
+		zones.push_back( { boundaries[i], boundaries[i + 1] } );
+
+	return zones;
+}
+
+int KdenliveProject::SaveRenderJobs(const vector<string> &media_folder_paths, const int zone_count, const string &file_name, const string &output_filepath, const string &render_extension){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::SaveRenderJobs");
+
+	const vector<RenderZone> zones = ComputeRenderZones(zone_count);
+	if(zones.empty())
+		return 0;
+
+	// Files may have been moved since the last save
+	ClearResolvedPaths();
+	project_folder_path = output_filepath;
+	KdenliveFile* file = GenerateNewFile(media_folder_paths, nullptr);
+
+	// Save a job for each zone. The zones are joined in order, so each starts on the frame after the previous one ends
+	const int file_framerate = getFileFramerate(framerate);
+	const string folder_prefix = (output_filepath != "") ? output_filepath + "/" : "";
+	stringstream zone_list;
+	stringstream render_commands;
+	stringstream wait_commands;
+
+	for(size_t i = 0; i < zones.size(); i++){
+		const string zone_name = file_name + "_zone" + to_string(i);
+		const int in_frame = lroundf(zones[i].start_time * file_framerate);
+		const int out_frame = lroundf(zones[i].end_time * file_framerate) - 1;
+
+		file->SetRenderZone(in_frame, out_frame);
+		file->SetRenderTarget(zone_name + "." + render_extension);
+		ofstream job = openOutputFile(folder_prefix + zone_name + ".mlt");
+		job << file->ToString();
+		job.close();
+
+		zone_list << "file '" << zone_name << "." << render_extension << "'\n";
+		render_commands << "melt -quiet \"" << zone_name << ".mlt\" &\npid" << i << "=$!\n";
+		wait_commands << "wait $pid" << i << " || status=1\n";
+	}
+
+	delete file;
+
+	ofstream zone_list_file = openOutputFile(folder_prefix + file_name + "_zones.txt");
+	zone_list_file << zone_list.str();
+	zone_list_file.close();
+
+	// The script runs from its own folder, since the jobs and zone list refer to each other by name
+	const string script_path = folder_prefix + file_name + "_render.sh";
+	ofstream script = openOutputFile(script_path);
+	script << "#!/bin/sh\n"
+		   << "# Renders " << file_name << " in " << zones.size() << " zones in parallel, and then joins them into " << file_name << "." << render_extension << "\n"
+		   << "cd \"$(dirname \"$0\")\" || exit 1\n\n"
+		   << render_commands.str() << "\n"
+		   << "status=0\n"
+		   << wait_commands.str()
+		   << "if [ $status -ne 0 ]; then\n"
+		   << "    echo \"Rendering a zone failed\" >&2\n"
+		   << "    exit 1\n"
+		   << "fi\n\n"
+		   << "ffmpeg -y -loglevel error -f concat -safe 0 -i \"" << file_name << "_zones.txt\" -c copy \"" << file_name << "." << render_extension << "\"\n";
+	script.close();
+
+	error_code error;
+	fs::permissions(script_path, fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec, fs::perm_options::add, error);
+
+	return zones.size();
+}
+
+
+// HELPERS
+Clip* KdenliveProject::AddNewClip(string name, const float length, const float start_offset){
+	clips.push_back( Clip(move(name), length, start_offset) );
+
+	Clip* new_clip = &clips.back();
+	new_clip->index = clips.size() - 1;
+	new_clip->project = this;
+
+	MarkChanged();
+
+	return new_clip;
+}
+
+// Clips are usually added in order, so hinting at the end makes each insert amortized constant time
+void KdenliveProject::AddToTimeline(const KdenliveFile::TrackType track_type, const float time_stamp, Clip* clip){
+	if(track_type == KdenliveFile::VIDEO){
+		video_timeline.emplace_hint( video_timeline.end(), time_stamp, clip );
+		video_index.Insert(time_stamp, clip);
+	}
+	else{
+		audio_timeline.emplace_hint( audio_timeline.end(), time_stamp, clip );
+		audio_index.Insert(time_stamp, clip);
+	}
+}
+
+void KdenliveProject::MarkChanged(){
+	change_count++;
+}
+
+void KdenliveProject::ClearModel(){
+	clips.clear();
+	video_timeline.clear();
+	audio_timeline.clear();
+	video_index.Clear();
+	audio_index.Clear();
+	sequence_clip_count = 0;
+	keyframed_clip_count = 0;
+	marked_clip_count = 0;
+	guides.clear();
+
+	// The previous file may refer to clips that no longer exist
+	delete generated_file;
+	generated_file = nullptr;
+	generated_tracks.clear();
+	generated_bin_ids.clear();
+
+	MarkChanged();
+}
+
+const string& KdenliveProject::ResolveMediaPath(const vector<string> &media_folder_paths, const string &name){
+	auto resolved_path = resolved_paths.find(name);
+	if(resolved_path == resolved_paths.end())
+		resolved_path = resolved_paths.emplace(name, findFilePath(media_folder_paths, name)).first;
+
+	return resolved_path->second;
+}
+
+vector<KdenliveProject*> KdenliveProject::FindSequenceProjects() const{
+	// Walk the sequences played by this project and the ones they play, visiting each project once
+	vector<KdenliveProject*> projects;
+	set<const KdenliveProject*> visited_projects;
+	const KdenliveProject* project = this;
+	size_t next_project = 0;
+	while(project != nullptr){
+		if(project->sequence_clip_count > 0){
+			for(const Clip &clip : project->clips){
+				if(clip.sequence != nullptr  &&  visited_projects.insert(clip.sequence).second)
+					projects.push_back(clip.sequence);
+			}
+		}
+		project = (next_project < projects.size()) ? projects[next_project++] : nullptr;
+	}
+
+	return projects;
+}
+
+void KdenliveProject::ClearResolvedPaths(){
+	resolved_paths.clear();
+	if(sequence_clip_count == 0)
+		return;
+
+	// The sequences are resolved again too, once per save
+	for(KdenliveProject* project : FindSequenceProjects())
+		project->resolved_paths.clear();
+}
+
+uint64_t KdenliveProject::HashModel(const vector<string> &media_folder_paths, map<const KdenliveProject*, uint64_t> &sequence_hashes){
+	KDENCODE_TRACE_SCOPE("KdenliveProject::HashModel");
+
+	ProjectHasher hasher;
+	hasher.AddString(PROJECT_HASH_VERSION);
+
+	// Profile
+	hasher.AddFloat(framerate);
+	hasher.AddInt(frame_width);
+	hasher.AddInt(frame_height);
+
+	// Clips, in the order they are added to the bin. Volumes only change the file when any are set
+	bool has_volumes = false;
+	for(const Clip &clip : clips)
+		has_volumes = has_volumes  ||  clip.volume != 0  ||  !clip.volume_keyframes.empty();
+	hasher.AddInt(clips.size());
+	for(const Clip &clip : clips){
+		hasher.AddString(clip.name);
+		if(clip.sequence != nullptr){
+			// Each project is hashed once, however many clips play it
+			auto sequence_hash = sequence_hashes.find(clip.sequence);
+			if(sequence_hash == sequence_hashes.end())
+				sequence_hash = sequence_hashes.emplace(clip.sequence, clip.sequence->HashModel(media_folder_paths, sequence_hashes)).first;
+			hasher.AddInt(sequence_hash->second);
+		}
+		else
+			hasher.AddString( ResolveMediaPath(media_folder_paths, clip.name) );
+		hasher.AddFloat(clip.length);
+		hasher.AddFloat(clip.start_offset);
+		hasher.AddFloat(clip.fade_in_time);
+		hasher.AddFloat(clip.fade_out_time);
+		hasher.AddInt(clip.priority);
+		if(has_volumes){
+			hasher.AddFloat(clip.volume);
+			hasher.AddInt(clip.volume_keyframes.size());
+			for(const VolumeKeyframe &keyframe : clip.volume_keyframes){
+				hasher.AddFloat(keyframe.time_stamp);
+				hasher.AddFloat(keyframe.volume);
+			}
+		}
+	}
+
+	// Preview chunks, which only change the file when any are set
+	if(preview_settings.min_stacked_video_clips > 0  ||  preview_settings.include_fades  ||  !preview_settings.ranges.empty()
+	   ||  !preview_settings.extension.empty()  ||  !preview_settings.parameters.empty()){
+		hasher.AddInt(preview_settings.min_stacked_video_clips);
+		hasher.AddInt(preview_settings.include_fades);
+		hasher.AddInt(preview_settings.ranges.size());
+		for(const PreviewRange &range : preview_settings.ranges){
+			hasher.AddFloat(range.start_time);
+			hasher.AddFloat(range.end_time);
+		}
+		hasher.AddString(preview_settings.extension);
+		hasher.AddString(preview_settings.parameters);
+	}
+
+	// Proxies, which only change the file when they are enabled
+	if(proxy_settings.is_enabled){
+		hasher.AddInt(proxy_settings.min_frame_width);
+		hasher.AddString(proxy_settings.params);
+		hasher.AddString(proxy_settings.extension);
+		for(const Clip &clip : clips)
+			hasher.AddInt(clip.use_proxy);
+		// Every clip name has been resolved above, so this includes proxies that are linked because they exist or by file size
+		for(const auto &resolved_path : resolved_paths)
+			hasher.AddString( FindProxyPath(media_folder_paths, resolved_path.first, false) );
+	}
+
+	// The layout of the clips, which only changes the file when gaps are filled or overlaps are mixed
+	if(is_filling_gaps)
+		hasher.AddString("fill_gaps");
+	if(is_crossfading)
+		hasher.AddString("crossfades");
+	if(ducking_settings.is_enabled){
+		hasher.AddString("ducking");
+		hasher.AddFloat(ducking_settings.volume);
+		hasher.AddFloat(ducking_settings.fade_time);
+		for(const Clip &clip : clips)
+			hasher.AddInt(clip.audio_role);
+	}
+	if(mix_settings.max_overlap_length > 0){
+		hasher.AddString("mix_overlaps");
+		hasher.AddFloat(mix_settings.max_overlap_length);
+		hasher.AddInt(mix_settings.has_transitions);
+	}
+
+	// Guides and markers, which only change the file when there are any
+	if(!guides.empty()  ||  marked_clip_count > 0){
+		const auto add_markers = [&hasher](const vector<Marker> &markers){
+			hasher.AddInt(markers.size());
+			for(const Marker &marker : markers){
+				hasher.AddFloat(marker.time_stamp);
+				hasher.AddString(marker.comment);
+				hasher.AddInt(marker.category);
+			}
+		};
+		add_markers(guides);
+		for(const Clip &clip : clips)
+			add_markers(clip.markers);
+	}
+
+	// Timelines, referring to clips by index
+	for(const auto &timeline : { &video_timeline, &audio_timeline }){
+		hasher.AddInt(timeline->size());
+		for(const auto &timeline_entry : *timeline){
+			hasher.AddFloat(timeline_entry.first);
+			hasher.AddInt(timeline_entry.second->index);
+		}
+	}
+
+	return hasher.hash;
 }
@@ -2,19 +2,110 @@
 #define KDENLIVEPROJECT_H
 
 
+#include <cstdint>
 #include <string>
-#include <list>
+#include <deque>
 #include <map>
 #include "KdenliveFile.h"
+#include "TimelineIndex.h"
+
+
+// MEDIA PATHS
+/**	Searches the media folders, in order, for a file whose name without its extension is file_name.
+ * 	Returns the path of the first match, or file_name with the default media extension if no file matched.
+ */
+std::string findFilePath(const std::vector<std::string> &media_folder_paths, const std::string &file_name);
 
 
 class KdenliveProject;
 
+// Timings and counts of a single generation, filled in by KdenliveProject when requested
+struct GenerationStats{
+	// Wall time of each phase, in seconds
+	double resolve_seconds = 0;		// Searching the media folders for the file of each clip
+	double allocate_seconds = 0;	// Assigning clips to tracks
+	double build_seconds = 0;		// Adding tracks, clips, and filters to the document
+	double print_seconds = 0;		// Converting the document to text
+	double write_seconds = 0;		// Writing the text to the output file
+	// Counts
+	long long clips_placed = 0;
+	long long blanks_emitted = 0;
+	long long filters_emitted = 0;
+	long long transitions_emitted = 0;	// Mixes and crossfades
+	long long tracks_created = 0;
+	long long xml_nodes = 0;		// Nodes in the generated document
+	long long bytes_written = 0;
+};
+
+// Settings for the proxy clips Kdenlive plays in place of heavy media, written to the document settings and the bin
+struct ProxySettings{
+	bool is_enabled = false;
+	int min_frame_width = 1000;		// Kdenlive generates a proxy for any clip wider than this, in pixels
+	uintmax_t min_file_size = 0;	// Clips whose media file is at least this many bytes are given a proxy, or 0 to only use Clip::SetUseProxy()
+	std::string params;				// FFmpeg parameters Kdenlive generates proxies with, or empty for its default
+	std::string extension = "mkv";	// Extension of the generated proxy files
+	std::string path_pattern = "proxy/{name}.mkv";	// Path of the proxy for each clip, where {name} is replaced with the clip name.
+													// Kdenlive finds relative paths from the folder of the project file
+
+	bool operator==(const ProxySettings &other) const;
+	bool operator!=(const ProxySettings &other) const;
+};
+
+// A range of the timeline that is rendered on its own, in seconds
+struct RenderZone{
+	float start_time;
+	float end_time;
+};
+
+// A range of the timeline that Kdenlive pre-renders as timeline preview chunks, in seconds
+struct PreviewRange{
+	float start_time;
+	float end_time;
+};
+
+// Settings for the timeline preview chunks Kdenlive pre-renders, so complex parts of the timeline play back smoothly
+struct PreviewSettings{
+	int min_stacked_video_clips = 0;	// Ranges where at least this many video clips play at once are pre-rendered, or 0 for none
+	bool include_fades = false;			// Fades on video clips are pre-rendered
+	std::vector<PreviewRange> ranges;	// Any other ranges to pre-render
+	std::string extension;				// Extension of the preview chunks, or empty for Kdenlive's default
+	std::string parameters;				// FFmpeg parameters the preview chunks are rendered with, or empty for Kdenlive's default
+
+	bool operator==(const PreviewSettings &other) const;
+	bool operator!=(const PreviewSettings &other) const;
+};
+
+// Settings for placing clips that overlap briefly on the same track, in the second playlist Kdenlive keeps on each track for mixes
+struct MixSettings{
+	float max_overlap_length = 0;	// Clips may share a track with a clip they overlap by at most this many seconds, or 0 to never share
+	bool has_transitions = true;	// A mix transition is added over each overlap, so Kdenlive dissolves or crossfades between the clips
+
+	bool operator==(const MixSettings &other) const;
+	bool operator!=(const MixSettings &other) const;
+};
+
+// Settings for lowering the volume of music wherever dialog plays, where clips are marked as either with Clip::SetAudioRole()
+struct DuckingSettings{
+	bool is_enabled = false;
+	float volume = -12;			// Change in the volume of the music while dialog plays, in dB
+	float fade_time = 0.25;		// Time the music takes to fade down before the dialog starts, and back up after it ends, in seconds
+
+	bool operator==(const DuckingSettings &other) const;
+	bool operator!=(const DuckingSettings &other) const;
+};
+
 // Class for managing clips
 class Clip{
 	friend KdenliveProject;
+	friend TimelineIndex;
 
 	public:
+	enum AudioRole{
+		OTHER,
+		DIALOG,
+		MUSIC,
+	};
+
 	/** Sets the bounds of the clip.
 	 *	Neither the length nor start offset can be non-positive.
 	 *	@param length specifies how long the clip will be on the track.
@@ -29,18 +120,51 @@ class Clip{
 	/**	Sets the visibility priority of a video clip in the timeline.
 	 * 	That is, if two video clips play at the same time, the clip with the higher priority will be visible.
 	 * 	This only affects clip which are added to a video track.
+	 * 	NOTE: If the clips on the video tracks have different priorities, they are layered by priority instead of filling gaps.
 	 */
-	// void SetPriority(const int priority); // NOT IMPLEMENTED
+	void SetPriority(const int priority);
+	/**	Marks the media of the clip to be played through a proxy in Kdenlive, at the path given by ProxySettings::path_pattern.
+	 * 	A proxy that doesn't exist yet is generated by Kdenlive when the project is opened.
+	 * 	This only has an effect if proxies are enabled with KdenliveProject::SetProxySettings().
+	 * 	NOTE: Proxies belong to the media, so every clip with the same name shares the proxy.
+	 */
+	void SetUseProxy(const bool use_proxy);
+	/**	Sets the volume of the clip, in dB, where 0 leaves the volume unchanged.
+	 * 	This only affects clips which are added to an audio track.
+	 */
+	void SetVolume(const float volume);
+	/**	Animates the volume of the clip between the given keyframes, whose times are from the start of the clip on the track.
+	 * 	The keyframes are used in place of the volume set by SetVolume(), and passing no keyframes removes them.
+	 * 	This only affects clips which are added to an audio track.
+	 */
+	void SetVolumeKeyframes(const std::vector<VolumeKeyframe> &volume_keyframes);
+	/**	Marks the clip as dialog or music, so music is lowered wherever dialog plays if ducking is enabled with KdenliveProject::SetDuckingSettings().
+	 * 	This only affects clips which are added to an audio track.
+	 */
+	void SetAudioRole(const AudioRole audio_role);
+	/**	Adds markers to the clip, after any markers already added, whose times are from the start of the clip's media.
+	 * 	This has no effect on sequence clips.
+	 * 	NOTE: Markers belong to the media, so every clip with the same name shows the markers of all of them.
+	 */
+	void AddMarkers(const std::vector<Marker> &markers);
 
 	private:
-	Clip(const std::string &name, const float length, const float start_offset = 0); // Clips should only be created from within the KdenliveProject
+	Clip(std::string name, const float length, const float start_offset = 0); // Clips should only be created from within the KdenliveProject
 	
+	KdenliveProject* project = nullptr;	// The project that created the clip, which is told when the clip changes
+	size_t index = 0;	// Position of the clip in KdenliveProject::clips
 	std::string name;
 	float length;
 	float start_offset;
 	float fade_in_time = 0;
 	float fade_out_time = 0;
 	int priority = 0;
+	bool use_proxy = false;
+	float volume = 0;
+	std::vector<VolumeKeyframe> volume_keyframes;
+	AudioRole audio_role = OTHER;
+	std::vector<Marker> markers;
+	KdenliveProject* sequence = nullptr;	// The project played by the clip, if it is a sequence clip
 };
 
 
@@ -50,6 +174,10 @@ class KdenliveProject{
 	/**	Creates a KdenliveProject with the default profile of 30 fps and 1080p resolution.
 	 */
 	KdenliveProject();
+	~KdenliveProject();
+	// Clips and the timeline refer to each other by pointer, so a project can't be copied
+	KdenliveProject(const KdenliveProject&) = delete;
+	KdenliveProject& operator=(const KdenliveProject&) = delete;
 	
 	// SETTERS
 	/**	Sets the profile of the video.
@@ -60,6 +188,46 @@ class KdenliveProject{
      *  @param frame_height specifies the length, in pixels, of the video
 	 */
 	void SetProfile(const float framerate, const int frame_width, const int frame_height);
+	/**	Sets whether Kdenlive should use proxy clips for the media of the project, and how they are generated.
+	 * 	When enabled, each clip is linked to the proxy at ProxySettings::path_pattern if the clip uses a proxy,
+	 * 	its media file is at least ProxySettings::min_file_size, or a pre-rendered proxy already exists at that path.
+	 * 	Kdenlive then generates any other proxies it needs for media wider than ProxySettings::min_frame_width.
+	 * 	Proxies are disabled by default.
+	 * 
+	 * 	NOTE: A relative proxy path is checked for in the folder SaveToFile() or SaveRenderJobs() saves to, since that is where Kdenlive looks for it.
+	 * 	SaveAsString(), GenerateFile(), and ComputeHash() don't know where the file will be saved, so they check the working directory instead.
+	 */
+	void SetProxySettings(const ProxySettings &proxy_settings);
+	/**	Sets which ranges of the timeline Kdenlive should pre-render as timeline preview chunks.
+	 * 	The chunks are written as dirty preview chunks, which Kdenlive renders once timeline preview is started.
+	 * 	Nothing is pre-rendered by default.
+	 */
+	void SetPreviewSettings(const PreviewSettings &preview_settings);
+	/**	Sets whether clips that overlap briefly are placed on the same track, rather than on a new track.
+	 * 	A clip that starts less than MixSettings::max_overlap_length before the clip on a track ends is placed in the track's second playlist,
+	 * 	which needs far fewer tracks for timelines where most clips overlap the next, such as crossfaded sequences.
+	 * 	Clips are still only placed this way if no track is free when they start. Overlaps are placed on new tracks by default.
+	 * 
+	 * 	NOTE: This only affects the default layout, not the layouts used when filling gaps or layering clips by priority.
+	 * 	Sequence clips are never placed in the second playlist.
+	 */
+	void SetMixSettings(const MixSettings &mix_settings);
+	/**	Enables or disables crossfades between clips on different tracks. It is disabled by default.
+	 * 	When enabled, wherever a clip starts while a clip on another track of the same type is ending, a single transition is added
+	 * 	over the overlap, which dissolves between video clips and crossfades between audio clips.
+	 * 	This is a true crossfade, and it needs half as many filters as giving both clips a fade with Clip::SetFadeOffsets().
+	 * 
+	 * 	NOTE: Each clip crossfades into at most one clip, and from at most one clip.
+	 */
+	void SetCrossfades(const bool is_crossfading);
+	/**	Sets whether music clips are lowered automatically wherever dialog clips play on the audio tracks, and by how much.
+	 * 	Overlapping dialog, and dialog close enough that the music wouldn't finish fading back up between it, is joined into a single range,
+	 * 	so each music clip is given one volume filter with as few keyframes as possible. Its volume from Clip::SetVolume() is lowered from.
+	 * 	Ducking is disabled by default.
+	 * 
+	 * 	NOTE: Music clips with their own volume keyframes are not lowered.
+	 */
+	void SetDuckingSettings(const DuckingSettings &ducking_settings);
 	/**	Creates a clip with the given name and length.
 	 * 	This clip can then be passed to AddClipToVideoTrack() and/or AddClipToAudioTrack() to add it to the timeline.
 	 * 	If you add the same Clip* multiple times to a track, then any changes made to the clip will be reflected across the entire timeline.
@@ -71,6 +239,21 @@ class KdenliveProject{
 	 *	@param start_offset specifies how far from the beginning of the clip that the clip will begin playing on the track.
 	 */
 	Clip* CreateClip(const std::string &name, const float length, const float start_offset = 0);
+	/**	Creates a clip that plays the entire timeline of another project, as a Kdenlive sequence.
+	 * 	The sequence is written to the file once, and every placement of the clip is a single entry that refers to it,
+	 * 	so a pattern of clips that repeats many times only adds its clips to the file once.
+	 * 	The clip is placed the same way as any other clip, with AddClipToVideoTrack() and/or AddClipToAudioTrack().
+	 * 
+	 * 	NOTE: The sequence project is read when this project is generated, so it must not be deleted before then.
+	 * 	Sequences can be nested, but a project can't be placed inside itself, directly or through other sequences.
+	 * 	
+	 * 	@param name specifies the name of the sequence in the bin.
+	 * 	@param sequence_project specifies the project whose timeline the sequence plays.
+	 * 	@param length specifies how long the clip will be on the track.
+	 *	@param start_offset specifies how far from the beginning of the sequence that the clip will begin playing on the track.
+	 *	@return the new clip, or nullptr if the sequence project is this project or already plays it.
+	 */
+	Clip* CreateSequenceClip(const std::string &name, KdenliveProject* sequence_project, const float length, const float start_offset = 0);
 	/**	Adds a video clip at the given time.
 	 * 
 	 * 	@param time_stamp specifies the time that the clip starts at.
@@ -101,13 +284,117 @@ class KdenliveProject{
 	 *	@param start_offset specifies how far from the beginning of the clip that the clip will begin playing on the track.
 	 */
 	Clip* CreateClipOnAudioTrack(const float time_stamp, const std::string &name, const float length, const float start_offset = 0);
+	/**	Creates and places every clip listed in a CSV or TSV manifest file.
+	 * 	The manifest is memory-mapped and tokenized in place, so no copy of the file is ever made.
+	 * 	Each row has the columns: time, name, length, start offset, fade in, fade out, track type.
+	 * 	The last four columns are optional and default to 0, and "video" respectively.
+	 * 	The track type may be "video", "audio", or "both", where "both" adds the same Clip* to a video and an audio track.
+	 * 	
+	 * 	NOTE: Tabs are used as the delimiter if the first line contains one, otherwise commas are used.
+	 * 	A header row, blank lines, and lines starting with '#' are skipped, as are rows that fail to parse.
+	 * 	Quoted names are supported, but they cannot contain escaped quotes.
+	 * 	
+	 * 	@param manifest_path is the path to the manifest file.
+	 * 	@return the number of rows that were imported.
+	 */
+	int ImportManifest(const std::string &manifest_path);
+	/**	Adds guides to the timeline, after any guides already added, whose times are from the start of the timeline.
+	 * 	Every guide is written to the file in a single pass, so chapter points or beat markers can be added by the tens of thousands.
+	 * 	NOTE: The guides of a project are not written when it is played as a sequence clip.
+	 */
+	void AddGuides(const std::vector<Marker> &guides);
+
+	// TIME QUERIES
+	/**	Finds every clip on the video or audio timeline that is playing at the given time.
+	 * 	A clip is playing from its time stamp, up to but not including the time it ends.
+	 * 	The timelines are indexed as clips are added, so this takes O(log n + k) time for k clips found, rather than a walk of the timeline.
+	 * 
+	 * 	@return the clips and the times they were placed at, in order of time.
+	 */
+	std::vector<TimelineClip> FindClipsAt(const KdenliveFile::TrackType track_type, const float time_stamp) const;
+	/**	Finds every clip on the video or audio timeline that plays for any part of the range from start_time up to end_time.
+	 * 	If the range is empty, this is the same as FindClipsAt(start_time).
+	 * 
+	 * 	@return the clips and the times they were placed at, in order of time.
+	 */
+	std::vector<TimelineClip> FindClipsInRange(const KdenliveFile::TrackType track_type, const float start_time, const float end_time) const;
+
+	// LOAD PROJECT FILE
+	/**	Replaces the contents of this project with the profile, clips, and timeline of an existing .kdenlive file.
+	 * 	Each playlist entry becomes a clip placed at its absolute time, with blanks resolved into positions,
+	 * 	and the fade filters on the entry (fade_from_black/fade_to_black on video, fadein/fadeout on audio) become the fades of the clip.
+	 * 	Clip names are taken from the file name (without extension) of the producer's resource.
+	 * 
+	 * 	NOTE: Anything this library does not model (effects, transitions, bin folders, etc.) is not loaded.
+	 * 	Any Clip* previously returned by this project becomes invalid.
+	 * 	Out points are inclusive, as in Kdenlive and MLT, so an entry lasts out - in + 1 frames of the file's profile.
+	 * 	The profile is only applied if the file has a timeline, and the clips are created in the order of the file's bin.
+	 * 
+	 * 	@param file_path is the path to the .kdenlive file.
+	 * 	@return true if the file was loaded, false if it could not be opened or parsed.
+	 */
+	bool LoadFromFile(const std::string &file_path);
+
+	// SNAPSHOTS
+	/**	Saves the profile, clips, and timeline of this project to a compact binary snapshot.
+	 * 	Unlike a .kdenlive file, a snapshot keeps the exact float values and which Clip* is placed where.
+	 * 	
+	 * 	The layout is versioned and little-endian: a header, a deduplicated string table of clip names and marker comments,
+	 * 	flat clip records with the audio role of each clip, flat video and audio timeline records, the volume and volume keyframes of each clip,
+	 * 	and the markers of each clip followed by the guides, each section aligned to 8 bytes.
+	 * 
+	 * 	NOTE: Projects with sequence clips can't be saved as a snapshot, since the projects they play aren't part of it.
+	 * 
+	 * 	@param file_path is the path to write the snapshot to.
+	 * 	@return true if the snapshot was written.
+	 */
+	bool SaveSnapshot(const std::string &file_path) const;
+	/**	Replaces the contents of this project with a snapshot written by SaveSnapshot().
+	 * 	The snapshot is memory-mapped and its records are read in place. Snapshots of earlier versions are read too.
+	 * 
+	 * 	NOTE: Any Clip* previously returned by this project becomes invalid.
+	 * 
+	 * 	@param file_path is the path to the snapshot.
+	 * 	@return true if the snapshot was loaded, false if it could not be opened or is not a valid snapshot.
+	 */
+	bool LoadSnapshot(const std::string &file_path);
 
 	// GENERATE PROJECT FILE
+	/**	Enables or disables incremental generation. It is disabled by default.
+	 * 	When enabled, the project keeps the KdenliveFile it last generated, and records every change made to the project since then.
+	 * 	The next save then only rebuilds the tracks whose clips changed, and only searches for the files of new clip names.
+	 * 	If nothing changed, the previous file is saved as is.
+	 * 
+	 * 	NOTE: A change to the profile, the media folder paths, or the number of tracks needed still rebuilds the whole file,
+	 * 	as does every save of a project that contains sequence clips or clips with volume keyframes or markers, places overlaps on the same track,
+	 * 	adds crossfades, or ducks music.
+	 * 	The file is equivalent to a full rebuild, but clips and filters may be numbered differently,
+	 * 	and clips that are no longer used stay in the bin.
+	 */
+	void SetIncrementalGeneration(const bool is_incremental);
+	/**	Enables or disables filling gaps when assigning clips to tracks. It is disabled by default.
+	 * 	When enabled, clips are assigned to tracks in the order they were created, each to the lowest track with a gap that fits it,
+	 * 	so creating a clip never moves the clips created before it to another track.
+	 * 	With incremental generation, a new clip then only rebuilds the track it is placed on, from the clip onward.
+	 * 
+	 * 	NOTE: Since the layout depends on the order clips were created, it may use more tracks than the default layout.
+	 * 	A Clip* that is added more than once is assigned a track for each placement when it is created.
+	 */
+	void SetFillGaps(const bool is_filling_gaps);
+	/**	Generates a new KdenliveFile from the project, which can then be modified further before saving.
+	 * 	SaveAsString() and SaveToFile() should be used instead, unless you need the KdenliveFile itself.
+	 * 	NOTE: The caller owns the returned file, and must delete it.
+	 * 
+	 * 	@param media_folder_paths is a collection of paths to folders that contain the media for the project.
+	 * 	@param stats is filled with the timings and counts of the generation, if it isn't null.
+	 */
+	KdenliveFile* GenerateFile(const std::vector<std::string> &media_folder_paths, GenerationStats* stats = nullptr);
 	/**	Generates a KdenliveFile and retrieves the string representing the file.
 	 * 
 	 * @param media_folder_paths is a collection of paths to folders that contain the media for the project.
+	 * @param stats is filled with the timings and counts of the generation, if it isn't null.
 	 */
-	std::string SaveAsString(const std::vector<std::string> &media_folder_paths);
+	std::string SaveAsString(const std::vector<std::string> &media_folder_paths, GenerationStats* stats = nullptr);
 	/**	Generates a KdenliveFile and saves the file to the given path.
 	 * 	This function appends ".kdenlive" to the file name automatically.
 	 * 	If no output filepath is specified, then it will save the file to current directory.
@@ -115,22 +402,159 @@ class KdenliveProject{
 	 * 	@param media_folder_paths is a collection of paths to folders that contain the media for the project.
 	 * 	@param output_filepath is the path you want to save the .kdenlive file to.
 	 * 	@param file_name is the name you want to give the .kdenlive file.
+	 * 	@param skip_if_unchanged specifies that the file should not be generated if the existing file was generated from a project with the same hash.
+	 * 	The hash of the project is stored in the main bin of the file, so checking it only reads the end of the existing file.
+	 * 	@param stats is filled with the timings and counts of the generation, if it isn't null.
+	 * 	@return true if the file was saved, false if it was skipped.
 	 */
-	void SaveToFile(const std::vector<std::string> &media_folder_paths, 
+	bool SaveToFile(const std::vector<std::string> &media_folder_paths, 
 					const std::string &file_name = "kdenlive_project",
-					const std::string &output_filepath = "");
+					const std::string &output_filepath = "",
+					const bool skip_if_unchanged = false,
+					GenerationStats* stats = nullptr);
+	/**	Computes a stable 64-bit hash of everything that determines the generated file:
+	 * 	the profile, every clip, both timelines, and the file path each clip name resolves to.
+	 * 	The hash is the same on every platform, and is computed in one pass over the project.
+	 * 
+	 * 	@param media_folder_paths is a collection of paths to folders that contain the media for the project.
+	 */
+	uint64_t ComputeHash(const std::vector<std::string> &media_folder_paths);
+
+	// RENDERING
+	/**	Computes the ranges of the timeline to pre-render as preview chunks, from the PreviewSettings of the project.
+	 * 	Stacked video is found in a single sweep over the video timeline, and overlapping ranges are merged.
+	 * 
+	 * 	@return the ranges, in order, without any overlapping.
+	 */
+	std::vector<PreviewRange> ComputePreviewRanges() const;
+	/**	Divides the timeline into at most zone_count zones that each take about the same time to render.
+	 * 	The cost of rendering is estimated as the length of the timeline, weighted by the number of clips playing at each moment.
+	 * 	Zone boundaries are placed on whole frames, and never cut through a clip that is max_uncut_clip_length seconds or shorter,
+	 * 	so fewer zones may be returned if the timeline can't be divided evenly.
+	 * 
+	 * 	@param zone_count is the number of zones to divide the timeline into.
+	 * 	@param max_uncut_clip_length is the length of the longest clip that must stay within a single zone.
+	 * 	@return the zones, in order, which together cover the entire timeline.
+	 */
+	std::vector<RenderZone> ComputeRenderZones(const int zone_count, const float max_uncut_clip_length = 5) const;
+	/**	Saves a render job for each zone from ComputeRenderZones(), and a shell script that renders them in parallel with melt.
+	 * 	Each job is a copy of the project file with the zone set on the final tractor, and a consumer that renders it to its own file.
+	 * 	The script waits for every job, and then joins the rendered zones into a single file with ffmpeg, without re-encoding them.
+	 * 	
+	 * 	The files saved are "<file_name>_zone<N>.mlt" for each zone, "<file_name>_zones.txt" listing the rendered zones,
+	 * 	and "<file_name>_render.sh", which renders "<file_name>.<render_extension>".
+	 * 
+	 * 	@param media_folder_paths is a collection of paths to folders that contain the media for the project.
+	 * 	@param zone_count is the number of zones to render in parallel, which should usually be the number of cores.
+	 * 	@param file_name is the name given to the saved files.
+	 * 	@param output_filepath is the path of the folder to save the files to, or empty for the current directory.
+	 * 	@param render_extension is the extension of the rendered files, which avformat chooses the format and codecs from.
+	 * 	@return the number of zones that jobs were saved for.
+	 */
+	int SaveRenderJobs(const std::vector<std::string> &media_folder_paths,
+					   const int zone_count,
+					   const std::string &file_name = "kdenlive_project",
+					   const std::string &output_filepath = "",
+					   const std::string &render_extension = "mp4");
 	
 	
 	private:
-	KdenliveFile* GenerateFile(const std::vector<std::string> &media_folder_paths);
+	// A clip placed on a track, with the values of the clip at the time it was placed
+	struct TrackPlacement{
+		int track_index;	// Index among the tracks of the same type
+		float time_stamp;
+		float blank_length;	// Length of the blank added before the clip, or 0 if there is none
+		const Clip* clip;
+		float length;
+		float start_offset;
+		float fade_in_time;
+		float fade_out_time;
+		bool is_in_mix_playlist = false;	// The clip is in the second playlist of the track
+		float mix_length = 0;				// Length of the overlap with the clip before it in the other playlist, or 0 if there is none
+		float volume = 0;
+
+		bool operator==(const TrackPlacement &other) const;
+		bool operator!=(const TrackPlacement &other) const;
+	};
+
+	Clip* AddNewClip(std::string name, const float length, const float start_offset);
+	void AddToTimeline(const KdenliveFile::TrackType track_type, const float time_stamp, Clip* clip);
+	void MarkChanged();
+	void ClearModel();
+	int AllocateTracks(const std::multimap<float, Clip*> &timeline, std::vector<TrackPlacement> &placements, const bool is_layered_by_priority) const;
+	int AllocateTracksFillingGaps(const std::multimap<float, Clip*> &timeline, std::vector<TrackPlacement> &placements) const;
+	int AllocateTracksMixingOverlaps(const std::multimap<float, Clip*> &timeline, std::vector<TrackPlacement> &placements) const;
+	int AllocateTracksByPriority(const std::multimap<float, Clip*> &timeline, std::vector<TrackPlacement> &placements) const;
+	void AddPlacementsInOrder(const std::vector<std::pair<float, const Clip*>> &timeline_entries, const std::vector<int> &entry_tracks, const int track_count,
+							  std::vector<TrackPlacement> &placements) const;
+	const std::string& ResolveMediaPath(const std::vector<std::string> &media_folder_paths, const std::string &name);
+	uint64_t HashModel(const std::vector<std::string> &media_folder_paths, std::map<const KdenliveProject*, uint64_t> &sequence_hashes);
+	std::vector<KdenliveProject*> FindSequenceProjects() const;
+	void ClearResolvedPaths();
+	void AddClipsToBin(KdenliveFile* kdenlive_file, const std::vector<std::string> &media_folder_paths, std::map<std::string, ClipId> &bin_ids, const size_t first_clip_index);
+	std::string FindProxyPath(const std::vector<std::string> &media_folder_paths, const std::string &name, const bool use_proxy);
+	void AddProxiesToBin(KdenliveFile* kdenlive_file, const std::vector<std::string> &media_folder_paths, const std::map<std::string, ClipId> &bin_ids);
+	void AddPreviewChunksToTimeline(KdenliveFile* kdenlive_file) const;
+	void AddMarkersToFile(KdenliveFile* kdenlive_file, const std::map<std::string, ClipId> &bin_ids, const size_t first_guide_index) const;
+	void AddCrossfades(KdenliveFile* kdenlive_file, const TrackId first_track_id, const std::vector<TrackPlacement> &placements, GenerationStats* stats) const;
+	void ComputeDuckKeyframes(const std::vector<TrackPlacement> &placements, std::vector<std::vector<VolumeKeyframe>> &duck_keyframes) const;
+	void AddPlacementToTrack(KdenliveFile* kdenlive_file, const TrackId track_id, const TrackPlacement &placement,
+							 const std::map<std::string, ClipId> &bin_ids, const std::map<const KdenliveProject*, SequenceId> &sequence_ids, GenerationStats* stats,
+							 const std::vector<VolumeKeyframe>* duck_keyframes = nullptr) const;
+	void AddSequencesToFile(KdenliveFile* kdenlive_file, const std::vector<std::string> &media_folder_paths,
+							std::map<std::string, ClipId> &bin_ids, std::map<const KdenliveProject*, SequenceId> &sequence_ids, GenerationStats* stats);
+	SequenceId BuildSequence(KdenliveFile* kdenlive_file, const std::vector<std::string> &media_folder_paths, const std::string &name,
+							 std::map<std::string, ClipId> &bin_ids, std::map<const KdenliveProject*, SequenceId> &sequence_ids, GenerationStats* stats);
+	KdenliveFile* BuildFile(const std::vector<std::string> &media_folder_paths,
+							const std::vector<TrackPlacement> &video_placements, const int video_track_count,
+							const std::vector<TrackPlacement> &audio_placements, const int audio_track_count,
+							std::map<std::string, ClipId> &bin_ids, GenerationStats* stats);
+	KdenliveFile* GenerateNewFile(const std::vector<std::string> &media_folder_paths, GenerationStats* stats);
+	KdenliveFile* UpdateGeneratedFile(const std::vector<std::string> &media_folder_paths, GenerationStats* stats);
+
+	friend Clip;
 
 	// PRIVATE VARIABLES
 	float framerate;
 	int frame_width;
 	int frame_height;
-	std::list<Clip> clips;
+	ProxySettings proxy_settings;
+	PreviewSettings preview_settings;
+	MixSettings mix_settings;
+	DuckingSettings ducking_settings;
+	std::deque<Clip> clips;		// deque keeps Clip* valid as clips are added, while allocating them in blocks
 	std::multimap<float, Clip*> video_timeline;
 	std::multimap<float, Clip*> audio_timeline;
+	TimelineIndex video_index;		// The timelines again, indexed for time queries
+	TimelineIndex audio_index;
+	std::map<std::string, std::string> resolved_paths;		// File path of each clip name, kept for the duration of one save
+	std::string project_folder_path;	// Folder the file is saved to, or empty for the working directory, kept for the duration of one save
+	std::vector<Marker> guides;
+	size_t sequence_clip_count = 0;
+	size_t keyframed_clip_count = 0;	// Clips with volume keyframes
+	size_t marked_clip_count = 0;		// Clips with markers
+	bool is_filling_gaps = false;
+	bool is_crossfading = false;
+	// Incremental generation
+	bool is_incremental = false;
+	unsigned long change_count = 0;
+	KdenliveFile* generated_file = nullptr;
+	unsigned long generated_change_count = 0;
+	size_t generated_clip_count = 0;
+	size_t generated_guide_count = 0;
+	std::vector<std::string> generated_media_folder_paths;
+	float generated_framerate = 0;
+	int generated_frame_width = 0;
+	int generated_frame_height = 0;
+	ProxySettings generated_proxy_settings;
+	PreviewSettings generated_preview_settings;
+	MixSettings generated_mix_settings;
+	DuckingSettings generated_ducking_settings;
+	bool generated_is_filling_gaps = false;
+	bool generated_is_crossfading = false;
+	int generated_video_track_count = 0;
+	std::map<std::string, ClipId> generated_bin_ids;
+	std::vector<std::vector<TrackPlacement>> generated_tracks;	// The placements on each track, indexed by TrackId
 };
 
 
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <charconv>
+#include "KeyframeWriter.h"
+
+using namespace std;
+
+
+// Longest keyframe that can be written: a separator, an int, '=', and the shortest form of a float, with room to spare
+const size_t MAX_KEYFRAME_LENGTH = 48;
+
+
+// CONSTRUCTORS
+KeyframeWriter::KeyframeWriter(){
+    buffer.push_back('\0');
+}
+
+
+// SETTERS
+void KeyframeWriter::Clear(){
+    buffer.clear();
+    buffer.push_back('\0');
+}
+
+void KeyframeWriter::AddKeyframe(const int frame, const float value){
+    // Write over the null character, into space that is only allocated when the buffer first grows this large
+    const size_t size = Size();
+    if(buffer.capacity() < size + MAX_KEYFRAME_LENGTH)
+        buffer.reserve( max(2 * buffer.capacity(), size + MAX_KEYFRAME_LENGTH) );
+    buffer.resize(size + MAX_KEYFRAME_LENGTH);
+
+    char* ptr = buffer.data() + size;
+    char* const end = buffer.data() + buffer.size();
+    if(size > 0)
+        *ptr++ = ';';
+    ptr = to_chars(ptr, end, frame).ptr;
+    *ptr++ = '=';
+    ptr = to_chars(ptr, end, value).ptr;
+
+    buffer.resize(ptr - buffer.data());
+    buffer.push_back('\0');
+}
+
+
+// GETTERS
+const char* KeyframeWriter::CStr() const{
+    return buffer.data();
+}
+
+size_t KeyframeWriter::Size() const{
+    return buffer.size() - 1;
+}
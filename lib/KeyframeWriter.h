@@ -0,0 +1,35 @@
+#ifndef KEYFRAMEWRITER_H
+#define KEYFRAMEWRITER_H
+
+#include <vector>
+
+
+// Writes MLT keyframe strings, "frame=value;frame=value;...", that animate a property of a filter.
+// The buffer is kept between strings, so once it is large enough, writing a string doesn't allocate.
+class KeyframeWriter{
+    public:
+    // CONSTRUCTORS
+    KeyframeWriter();
+
+    // SETTERS
+    /** Starts a new string, keeping the buffer of the last one.
+     */
+    void Clear();
+    /** Adds a keyframe to the end of the string. Frames should be added in increasing order.
+     */
+    void AddKeyframe(const int frame, const float value);
+
+    // GETTERS
+    /** Returns the string, which is valid until the writer is next changed.
+     */
+    const char* CStr() const;
+    size_t Size() const;
+
+
+    private:
+    // PRIVATE VARIABLES
+    std::vector<char> buffer;       // Always ends with a null character, which is not counted by Size()
+};
+
+
+#endif
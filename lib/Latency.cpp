@@ -0,0 +1,182 @@
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <vector>
+#include "Latency.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace std;
+
+
+// Every histogram that currently exists. Histograms are static, so this must be created before any of them
+mutex& getLatencyHistogramsMutex(){
+    static mutex histograms_mutex;
+    return histograms_mutex;
+}
+vector<LatencyHistogram*>& getLatencyHistograms(){
+    static vector<LatencyHistogram*> histograms;
+    return histograms;
+}
+
+uint64_t getLatencyTime(){
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Index of the highest set bit. The value must not be 0
+int getHighestBit(const uint64_t value){
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+void writeMicroseconds(ostream &output, const uint64_t ns){
+    output << ns / 1000 << "." << ns % 1000 / 100 << ns % 100 / 10 << ns % 10;
+}
+
+
+// LATENCY HISTOGRAMS
+void writeLatencyHistograms(ostream &output){
+    lock_guard<mutex> lock(getLatencyHistogramsMutex());
+
+    output << "{\"histograms\":[";
+
+    bool is_first_histogram = true;
+    for(const LatencyHistogram* histogram : getLatencyHistograms()){
+        output << (is_first_histogram ? "\n" : ",\n") << "{\"name\":\"" << histogram->GetName() << "\",\"count\":" << histogram->GetCount();
+        output << ",\"p50_us\":";
+        writeMicroseconds(output, histogram->GetPercentile(50));
+        output << ",\"p90_us\":";
+        writeMicroseconds(output, histogram->GetPercentile(90));
+        output << ",\"p99_us\":";
+        writeMicroseconds(output, histogram->GetPercentile(99));
+        output << ",\"max_us\":";
+        writeMicroseconds(output, histogram->GetMax());
+        output << "}";
+        is_first_histogram = false;
+    }
+
+    output << "\n]}\n";
+}
+
+bool saveLatencyHistograms(const string &file_path){
+    ofstream output(file_path);
+    if(!output.good())
+        return false;
+
+    writeLatencyHistograms(output);
+    return output.good();
+}
+
+void clearLatencyHistograms(){
+    lock_guard<mutex> lock(getLatencyHistogramsMutex());
+
+    for(LatencyHistogram* histogram : getLatencyHistograms())
+        histogram->Clear();
+}
+
+
+// LatencyHistogram
+LatencyHistogram::LatencyHistogram(const char* call_name){
+    this->call_name = call_name;
+    for(atomic<uint64_t> &bucket : buckets)
+        bucket.store(0, memory_order_relaxed);
+
+    lock_guard<mutex> lock(getLatencyHistogramsMutex());
+    getLatencyHistograms().push_back(this);
+}
+
+LatencyHistogram::~LatencyHistogram(){
+    lock_guard<mutex> lock(getLatencyHistogramsMutex());
+
+    vector<LatencyHistogram*> &histograms = getLatencyHistograms();
+    for(size_t i = 0; i < histograms.size(); i++){
+        if(histograms[i] == this){
+            histograms.erase(histograms.begin() + i);
+            break;
+        }
+    }
+}
+
+void LatencyHistogram::Record(const uint64_t latency_ns){
+    buckets[GetBucketIndex(latency_ns)].fetch_add(1, memory_order_relaxed);
+    count.fetch_add(1, memory_order_relaxed);
+
+    uint64_t previous_max = max_ns.load(memory_order_relaxed);
+    while(latency_ns > previous_max  &&  !max_ns.compare_exchange_weak(previous_max, latency_ns, memory_order_relaxed)){}
+}
+
+void LatencyHistogram::Clear(){
+    for(atomic<uint64_t> &bucket : buckets)
+        bucket.store(0, memory_order_relaxed);
+    count.store(0, memory_order_relaxed);
+    max_ns.store(0, memory_order_relaxed);
+}
+
+const char* LatencyHistogram::GetName() const{
+    return call_name;
+}
+
+uint64_t LatencyHistogram::GetCount() const{
+    return count.load(memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetPercentile(const double percentile) const{
+    // Count the buckets themselves, since calls may be recorded while this is running
+    uint64_t total = 0;
+    for(const atomic<uint64_t> &bucket : buckets)
+        total += bucket.load(memory_order_relaxed);
+    if(total == 0)
+        return 0;
+
+    const uint64_t target = max<uint64_t>(1, static_cast<uint64_t>( ceil(percentile / 100 * total) ));
+    uint64_t seen = 0;
+    for(int i = 0; i < BUCKET_COUNT; i++){
+        seen += buckets[i].load(memory_order_relaxed);
+        if(seen >= target)
+            return min(GetBucketMax(i), GetMax());
+    }
+
+    return GetMax();
+}
+
+uint64_t LatencyHistogram::GetMax() const{
+    return max_ns.load(memory_order_relaxed);
+}
+
+int LatencyHistogram::GetBucketIndex(const uint64_t latency_ns){
+    if(latency_ns < EXACT_BUCKET_COUNT)
+        return latency_ns;
+
+    // The power of two, then the top bits below it
+    const int highest_bit = getHighestBit(latency_ns);
+    const int sub_bucket = (latency_ns >> (highest_bit - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1);
+    return EXACT_BUCKET_COUNT + (highest_bit - 5) * (1 << SUB_BUCKET_BITS) + sub_bucket;
+}
+
+uint64_t LatencyHistogram::GetBucketMax(const int bucket_index){
+    if(bucket_index < EXACT_BUCKET_COUNT)
+        return bucket_index;
+
+    const int highest_bit = (bucket_index - EXACT_BUCKET_COUNT) / (1 << SUB_BUCKET_BITS) + 5;
+    const uint64_t sub_bucket = (bucket_index - EXACT_BUCKET_COUNT) % (1 << SUB_BUCKET_BITS);
+    const int sub_bucket_shift = highest_bit - SUB_BUCKET_BITS;
+    return ( ((1ULL << SUB_BUCKET_BITS) + sub_bucket) << sub_bucket_shift ) + ( (1ULL << sub_bucket_shift) - 1 );
+}
+
+
+// LatencyScope
+LatencyScope::LatencyScope(LatencyHistogram &histogram) : histogram(histogram){
+    start_ns = getLatencyTime();
+}
+
+LatencyScope::~LatencyScope(){
+    histogram.Record(getLatencyTime() - start_ns);
+}
@@ -0,0 +1,92 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+
+// LATENCY HISTOGRAMS
+// Per-call latencies are only recorded when the library is compiled with KDENCODE_LATENCY_HISTOGRAMS defined.
+// Otherwise KDENCODE_LATENCY_SCOPE() compiles to nothing, and the functions below produce no histograms.
+#ifdef KDENCODE_LATENCY_HISTOGRAMS
+#define KDENCODE_LATENCY_CONCAT_INNER(a, b) a##b
+#define KDENCODE_LATENCY_CONCAT(a, b) KDENCODE_LATENCY_CONCAT_INNER(a, b)
+/** Records the time from this line until the end of the enclosing scope into the histogram named call_name.
+ *  Each use of the macro has its own histogram, so it should only be used once per call.
+ *  The name must be a string literal.
+ */
+#define KDENCODE_LATENCY_SCOPE(call_name) \
+    static LatencyHistogram KDENCODE_LATENCY_CONCAT(latency_histogram_, __LINE__)(call_name); \
+    LatencyScope KDENCODE_LATENCY_CONCAT(latency_scope_, __LINE__)(KDENCODE_LATENCY_CONCAT(latency_histogram_, __LINE__))
+#else
+#define KDENCODE_LATENCY_SCOPE(call_name)
+#endif
+
+/** Writes the count, p50, p90, p99 and max latency of every histogram as JSON, in microseconds.
+ *  This can be called at any time, including while calls are being recorded on other threads.
+ */
+void writeLatencyHistograms(std::ostream &output);
+/** Writes every histogram to a JSON file.
+ *  Returns false if the file could not be opened.
+ */
+bool saveLatencyHistograms(const std::string &file_path);
+/** Resets every histogram, so that latencies can be compared between two points in time (e.g. as the document grows).
+ */
+void clearLatencyHistograms();
+
+
+// Log-linear histogram of latencies in nanoseconds, with a relative precision of 1/16 (~6%) at every magnitude.
+// Recording is lock-free, so it can be done from any thread.
+class LatencyHistogram{
+    public:
+    /** Creates an empty histogram, and registers it so it is included by writeLatencyHistograms().
+     */
+    LatencyHistogram(const char* call_name);
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void Record(const uint64_t latency_ns);
+    void Clear();
+
+    const char* GetName() const;
+    uint64_t GetCount() const;
+    /** Returns the highest latency that is within the bucket holding the given percentile (0-100), in nanoseconds.
+     */
+    uint64_t GetPercentile(const double percentile) const;
+    uint64_t GetMax() const;
+
+
+    private:
+    static const int EXACT_BUCKET_COUNT = 32;   // Latencies below this are counted exactly
+    static const int SUB_BUCKET_BITS = 4;       // Every power of two above that is split into 16 buckets
+    static const int BUCKET_COUNT = EXACT_BUCKET_COUNT + (64 - 5) * (1 << SUB_BUCKET_BITS);
+
+    static int GetBucketIndex(const uint64_t latency_ns);
+    static uint64_t GetBucketMax(const int bucket_index);
+
+    const char* call_name;
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+};
+
+// Records the lifetime of the scope into a histogram
+class LatencyScope{
+    public:
+    LatencyScope(LatencyHistogram &histogram);
+    ~LatencyScope();
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+    private:
+    LatencyHistogram &histogram;
+    uint64_t start_ns;
+};
+
+
+#endif
@@ -0,0 +1,111 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// CONSTRUCTORS
+#ifdef _WIN32
+MappedFile::MappedFile(const string &file_path){
+    data = nullptr;
+    size = 0;
+    is_open = false;
+    file_handle = INVALID_HANDLE_VALUE;
+    mapping_handle = nullptr;
+
+    // Open the file
+    file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file_handle == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file_handle, &file_size))
+        return;
+    size = static_cast<size_t>(file_size.QuadPart);
+
+    // Empty files can't be mapped, but are still valid
+    if(size == 0){
+        is_open = true;
+        return;
+    }
+
+    // Map the entire file
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping_handle == nullptr)
+        return;
+
+    data = static_cast<const char*>( MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) );
+    is_open = data != nullptr;
+}
+
+MappedFile::~MappedFile(){
+    if(data != nullptr)
+        UnmapViewOfFile(data);
+    if(mapping_handle != nullptr)
+        CloseHandle(mapping_handle);
+    if(file_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(file_handle);
+}
+#else
+MappedFile::MappedFile(const string &file_path){
+    data = nullptr;
+    size = 0;
+    is_open = false;
+
+    // Open the file
+    file_descriptor = open(file_path.c_str(), O_RDONLY);
+    if(file_descriptor < 0)
+        return;
+
+    struct stat file_stat;
+    if(fstat(file_descriptor, &file_stat) != 0)
+        return;
+    size = static_cast<size_t>(file_stat.st_size);
+
+    // Empty files can't be mapped, but are still valid
+    if(size == 0){
+        is_open = true;
+        return;
+    }
+
+    // Map the entire file
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if(mapping == MAP_FAILED)
+        return;
+
+    // The file is read front to back, so let the kernel read ahead aggressively
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    data = static_cast<const char*>(mapping);
+    is_open = true;
+}
+
+MappedFile::~MappedFile(){
+    if(data != nullptr)
+        munmap(const_cast<char*>(data), size);
+    if(file_descriptor >= 0)
+        close(file_descriptor);
+}
+#endif
+
+
+// GETTERS
+bool MappedFile::IsOpen() const{
+    return is_open;
+}
+
+const char* MappedFile::Data() const{
+    return data;
+}
+
+size_t MappedFile::Size() const{
+    return size;
+}
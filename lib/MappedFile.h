@@ -0,0 +1,49 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+
+// Read-only memory mapping of an entire file
+class MappedFile{
+    public:
+    // CONSTRUCTORS
+    /** Maps the file at the given path into memory.
+     *  If the file could not be opened or mapped, IsOpen() will return false.
+     */
+    MappedFile(const std::string &file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // GETTERS
+    /** Returns true if the file was mapped successfully.
+     *  An empty file is considered open, but has a null Data() pointer.
+     */
+    bool IsOpen() const;
+    /** Returns a pointer to the first byte of the file.
+     *  NOTE: The data is NOT null terminated, so it must always be bounded by Size().
+     */
+    const char* Data() const;
+    /** Returns the size of the file, in bytes.
+     */
+    size_t Size() const;
+
+
+    private:
+    // PRIVATE VARIABLES
+    const char* data;
+    size_t size;
+    bool is_open;
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#else
+    int file_descriptor;
+#endif
+};
+
+
+#endif
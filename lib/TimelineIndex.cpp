@@ -0,0 +1,147 @@
+#include <algorithm>
+#include "KdenliveProject.h"
+#include "TimelineIndex.h"
+
+using namespace std;
+
+
+// CONSTRUCTORS
+TimelineIndex::TimelineIndex(){
+	are_end_times_changed = false;
+	root = -1;
+}
+
+
+// SETTERS
+void TimelineIndex::Insert(const float time_stamp, Clip* clip){
+	Node node = { time_stamp, clip, -1, -1, priorities.Next(), 0 };
+	node.max_end_time = GetEndTime(node);
+	nodes.push_back(node);
+
+	int left, right;
+	Split(root, time_stamp, left, right);
+	root = Merge( Merge(left, nodes.size() - 1), right );
+}
+
+void TimelineIndex::MarkLengthsChanged(){
+	are_end_times_changed = true;
+}
+
+void TimelineIndex::Clear(){
+	nodes.clear();
+	are_end_times_changed = false;
+	root = -1;
+}
+
+
+// GETTERS
+void TimelineIndex::FindClipsAt(const float time_stamp, vector<TimelineClip> &clips) const{
+	if(are_end_times_changed)
+		UpdateAll();
+
+	CollectClips(root, time_stamp, time_stamp, true, clips);
+}
+
+void TimelineIndex::FindClipsInRange(const float start_time, const float end_time, vector<TimelineClip> &clips) const{
+	// An empty range is the same as a single point in time
+	if(end_time <= start_time){
+		FindClipsAt(start_time, clips);
+		return;
+	}
+
+	if(are_end_times_changed)
+		UpdateAll();
+
+	CollectClips(root, start_time, end_time, false, clips);
+}
+
+
+// HELPERS
+void TimelineIndex::Update(const int node) const{
+	Node &cur = nodes[node];
+	cur.max_end_time = max( GetEndTime(cur), max(GetMaxEndTime(cur.left), GetMaxEndTime(cur.right)) );
+}
+
+void TimelineIndex::UpdateAll() const{
+	// Parents come before their children in pre-order, so updating in reverse updates the children first
+	vector<int> pre_order;
+	pre_order.reserve(nodes.size());
+	vector<int> remaining;
+	if(root != -1)
+		remaining.push_back(root);
+	while(!remaining.empty()){
+		const int node = remaining.back();
+		remaining.pop_back();
+		pre_order.push_back(node);
+
+		if(nodes[node].left != -1)
+			remaining.push_back(nodes[node].left);
+		if(nodes[node].right != -1)
+			remaining.push_back(nodes[node].right);
+	}
+
+	for(auto node = pre_order.rbegin(); node != pre_order.rend(); node++)
+		Update(*node);
+	are_end_times_changed = false;
+}
+
+// Splits the subtree into the clips at or before the time, and the clips after it
+void TimelineIndex::Split(const int node, const float time_stamp, int &left, int &right){
+	if(node == -1){
+		left = -1;
+		right = -1;
+		return;
+	}
+
+	if(time_stamp < nodes[node].time_stamp){
+		Split(nodes[node].left, time_stamp, left, nodes[node].left);
+		right = node;
+	}
+	else{
+		Split(nodes[node].right, time_stamp, nodes[node].right, right);
+		left = node;
+	}
+	Update(node);
+}
+
+// Joins two subtrees, where every clip of left comes before every clip of right
+int TimelineIndex::Merge(const int left, const int right){
+	if(left == -1)
+		return right;
+	if(right == -1)
+		return left;
+
+	if(nodes[left].priority > nodes[right].priority){
+		nodes[left].right = Merge(nodes[left].right, right);
+		Update(left);
+		return left;
+	}
+	nodes[right].left = Merge(left, nodes[right].left);
+	Update(right);
+	return right;
+}
+
+void TimelineIndex::CollectClips(const int node, const float start_time, const float end_time, const bool is_start_included, vector<TimelineClip> &clips) const{
+	// Nothing in the subtree is still playing at the start of the range
+	if(node == -1  ||  nodes[node].max_end_time <= start_time)
+		return;
+
+	const Node &cur = nodes[node];
+	CollectClips(cur.left, start_time, end_time, is_start_included, clips);
+
+	// Clips to the right start even later
+	if(cur.time_stamp > end_time  ||  (cur.time_stamp == end_time  &&  !is_start_included))
+		return;
+
+	if(GetEndTime(cur) > start_time)
+		clips.push_back( {cur.time_stamp, cur.clip} );
+	CollectClips(cur.right, start_time, end_time, is_start_included, clips);
+}
+
+float TimelineIndex::GetEndTime(const Node &node) const{
+	return node.time_stamp + node.clip->length;
+}
+
+float TimelineIndex::GetMaxEndTime(const int node) const{
+	return (node != -1) ? nodes[node].max_end_time : 0;
+}
@@ -0,0 +1,70 @@
+#ifndef TIMELINEINDEX_H
+#define TIMELINEINDEX_H
+
+#include <cstdint>
+#include <vector>
+#include "TreapPriority.h"
+
+
+class Clip;
+
+// A clip placed on the timeline, as found by the time queries of KdenliveProject
+struct TimelineClip{
+	float time_stamp;
+	Clip* clip;
+};
+
+// Interval tree of the clips placed on a timeline, ordered by start time.
+// Each subtree knows the latest time any of its clips end at, so the clips playing at a time, or within a range of time,
+// are found without looking at the clips that end before it. Adding a clip is O(log n).
+class TimelineIndex{
+	public:
+	// CONSTRUCTORS
+	TimelineIndex();
+
+	// SETTERS
+	/**	Adds a clip at the given time, after any clips already added at the same time.
+	 */
+	void Insert(const float time_stamp, Clip* clip);
+	/**	Marks the lengths of the clips as changed, so the end times are worked out again before the next query.
+	 */
+	void MarkLengthsChanged();
+	void Clear();
+
+	// GETTERS
+	/**	Appends every clip playing at the given time to clips, in order of time.
+	 * 	A clip is playing from its time stamp, up to but not including the time it ends.
+	 */
+	void FindClipsAt(const float time_stamp, std::vector<TimelineClip> &clips) const;
+	/**	Appends every clip that plays for any part of the range from start_time up to end_time to clips, in order of time.
+	 */
+	void FindClipsInRange(const float start_time, const float end_time, std::vector<TimelineClip> &clips) const;
+
+
+	private:
+	struct Node{
+		float time_stamp;
+		Clip* clip;
+		int left;
+		int right;
+		uint32_t priority;
+		float max_end_time;		// Latest time any clip in the subtree ends at
+	};
+
+	void Update(const int node) const;
+	void UpdateAll() const;
+	void Split(const int node, const float time_stamp, int &left, int &right);
+	int Merge(const int left, const int right);
+	void CollectClips(const int node, const float start_time, const float end_time, const bool is_start_included, std::vector<TimelineClip> &clips) const;
+	float GetEndTime(const Node &node) const;
+	float GetMaxEndTime(const int node) const;
+
+	// PRIVATE VARIABLES
+	mutable std::vector<Node> nodes;	// The end times are refreshed by the queries, if clip lengths have changed since
+	mutable bool are_end_times_changed;
+	int root;
+	TreapPriority priorities;
+};
+
+
+#endif
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Trace.h"
+
+using namespace std;
+
+
+const uint64_t TRACE_BUFFER_CAPACITY = 1 << 16;     // Events kept per thread. Must be a power of two
+
+
+struct TraceEvent{
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+// Ring buffer that is only ever written to by the thread that owns it, so recording an event needs no lock
+struct TraceBuffer{
+    int thread_id;
+    std::atomic<uint64_t> event_count{0};     // Every event ever recorded, including those that have been overwritten
+    TraceEvent events[TRACE_BUFFER_CAPACITY];
+};
+
+// Every buffer that has been created. A thread only locks this once, when it records its first event
+mutex trace_buffers_mutex;
+vector<unique_ptr<TraceBuffer>> trace_buffers;
+
+
+TraceBuffer* getThreadTraceBuffer(){
+    // Buffers belong to trace_buffers, so their events outlive the thread that recorded them
+    thread_local TraceBuffer* thread_buffer = nullptr;
+
+    if(thread_buffer == nullptr){
+        lock_guard<mutex> lock(trace_buffers_mutex);
+        trace_buffers.push_back( make_unique<TraceBuffer>() );
+        thread_buffer = trace_buffers.back().get();
+        thread_buffer->thread_id = trace_buffers.size();
+    }
+
+    return thread_buffer;
+}
+
+uint64_t getTraceTime(){
+    static const chrono::steady_clock::time_point trace_start = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - trace_start).count();
+}
+
+void writeEscapedJsonString(ostream &output, const char* str){
+    output << '"';
+    for(const char* ptr = str; *ptr != '\0'; ptr++){
+        if(*ptr == '"'  ||  *ptr == '\\')
+            output << '\\';
+        output << *ptr;
+    }
+    output << '"';
+}
+
+
+// TRACING
+void writeTraceEvents(ostream &output){
+    lock_guard<mutex> lock(trace_buffers_mutex);
+
+    output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool is_first_event = true;
+    for(const unique_ptr<TraceBuffer> &buffer : trace_buffers){
+        // Only the most recent events of each thread are still in its buffer
+        const uint64_t event_count = buffer->event_count.load(memory_order_acquire);
+        const uint64_t first_event = (event_count > TRACE_BUFFER_CAPACITY) ? event_count - TRACE_BUFFER_CAPACITY : 0;
+
+        for(uint64_t i = first_event; i < event_count; i++){
+            const TraceEvent &event = buffer->events[i & (TRACE_BUFFER_CAPACITY - 1)];
+
+            output << (is_first_event ? "\n" : ",\n") << "{\"name\":";
+            writeEscapedJsonString(output, event.name);
+            output << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+                   << ",\"ts\":" << event.start_ns / 1000 << "." << event.start_ns % 1000 / 100 << event.start_ns % 100 / 10 << event.start_ns % 10
+                   << ",\"dur\":" << event.duration_ns / 1000 << "." << event.duration_ns % 1000 / 100 << event.duration_ns % 100 / 10 << event.duration_ns % 10
+                   << "}";
+            is_first_event = false;
+        }
+    }
+
+    output << "\n]}\n";
+}
+
+bool saveTraceEvents(const string &file_path){
+    ofstream output(file_path);
+    if(!output.good())
+        return false;
+
+    writeTraceEvents(output);
+    return output.good();
+}
+
+void clearTraceEvents(){
+    lock_guard<mutex> lock(trace_buffers_mutex);
+
+    for(const unique_ptr<TraceBuffer> &buffer : trace_buffers)
+        buffer->event_count.store(0, memory_order_release);
+}
+
+
+// TraceScope
+TraceScope::TraceScope(const char* event_name){
+    this->event_name = event_name;
+    start_ns = getTraceTime();
+}
+
+TraceScope::~TraceScope(){
+    const uint64_t end_ns = getTraceTime();
+    TraceBuffer* buffer = getThreadTraceBuffer();
+
+    // Write the event, then publish it
+    const uint64_t event_index = buffer->event_count.load(memory_order_relaxed);
+    buffer->events[event_index & (TRACE_BUFFER_CAPACITY - 1)] = { event_name, start_ns, end_ns - start_ns };
+    buffer->event_count.store(event_index + 1, memory_order_release);
+}
@@ -0,0 +1,53 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+
+// TRACING
+// Scoped trace events are only recorded when the library is compiled with KDENCODE_TRACING defined.
+// Otherwise KDENCODE_TRACE_SCOPE() compiles to nothing, and the functions below produce an empty trace.
+#ifdef KDENCODE_TRACING
+#define KDENCODE_TRACE_CONCAT_INNER(a, b) a##b
+#define KDENCODE_TRACE_CONCAT(a, b) KDENCODE_TRACE_CONCAT_INNER(a, b)
+/** Records an event named event_name, lasting from this line until the end of the enclosing scope.
+ *  The name must be a string literal, or otherwise live until the trace is dumped.
+ */
+#define KDENCODE_TRACE_SCOPE(event_name) TraceScope KDENCODE_TRACE_CONCAT(trace_scope_, __LINE__)(event_name)
+#else
+#define KDENCODE_TRACE_SCOPE(event_name)
+#endif
+
+/** Writes every recorded event, from every thread, as Chrome trace_event JSON.
+ *  The output can be opened in chrome://tracing or https://ui.perfetto.dev.
+ *  NOTE: Each thread keeps only its most recent events, and this should be called once the traced work has finished.
+ */
+void writeTraceEvents(std::ostream &output);
+/** Writes every recorded event to a Chrome trace_event JSON file.
+ *  Returns false if the file could not be opened.
+ */
+bool saveTraceEvents(const std::string &file_path);
+/** Discards every recorded event.
+ *  NOTE: This should not be called while other threads are recording events.
+ */
+void clearTraceEvents();
+
+
+// Records a single event over its lifetime into the ring buffer of the current thread
+class TraceScope{
+    public:
+    TraceScope(const char* event_name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+    const char* event_name;
+    uint64_t start_ns;
+};
+
+
+#endif
@@ -0,0 +1,225 @@
+#include "TrackIndex.h"
+
+using namespace std;
+
+
+// CONSTRUCTORS
+TrackIndex::TrackIndex(){
+    root = -1;
+}
+
+
+// SETTERS
+void TrackIndex::PushBack(const Entry &entry){
+    Insert(Size(), entry);
+}
+
+void TrackIndex::Insert(const size_t index, const Entry &entry){
+    int left, right;
+    Split(root, index, left, right);
+    root = Merge( Merge(left, CreateNode(entry)), right );
+}
+
+void TrackIndex::Erase(const size_t index){
+    int left, middle, right;
+    Split(root, index, left, right);
+    Split(right, 1, middle, right);
+    FreeTree(middle);
+    root = Merge(left, right);
+}
+
+void TrackIndex::Set(const size_t index, const Entry &entry){
+    int left, middle, right;
+    Split(root, index, left, right);
+    Split(right, 1, middle, right);
+    nodes[middle].entry = entry;
+    Update(middle);
+    root = Merge( Merge(left, middle), right );
+}
+
+void TrackIndex::Truncate(const size_t index){
+    int left, right;
+    Split(root, index, left, right);
+    FreeTree(right);
+    root = left;
+}
+
+
+// GETTERS
+size_t TrackIndex::Size() const{
+    return GetSize(root);
+}
+
+const TrackIndex::Entry& TrackIndex::At(const size_t index) const{
+    return nodes[FindNode(index)].entry;
+}
+
+double TrackIndex::GetStartTime(size_t index) const{
+    double start_time = 0;
+    int node = root;
+    while(node != -1){
+        const Node &cur = nodes[node];
+        const uint32_t left_size = GetSize(cur.left);
+        if(index < left_size){
+            node = cur.left;
+            continue;
+        }
+
+        start_time += GetLength(cur.left);
+        if(index == left_size)
+            break;
+        start_time += cur.entry.length;
+        index -= left_size + 1;
+        node = cur.right;
+    }
+
+    return start_time;
+}
+
+size_t TrackIndex::FindIndexAt(double time) const{
+    if(time < 0  ||  time >= GetLength(root))
+        return Size();
+
+    size_t index = 0;
+    int node = root;
+    while(node != -1){
+        const Node &cur = nodes[node];
+        const double left_length = GetLength(cur.left);
+        if(time < left_length){
+            node = cur.left;
+            continue;
+        }
+
+        time -= left_length;
+        index += GetSize(cur.left);
+        // Rounding can leave the time just past the last entry of the subtree, in which case it belongs to that entry
+        if(time < cur.entry.length  ||  cur.right == -1)
+            return index;
+        time -= cur.entry.length;
+        index++;
+        node = cur.right;
+    }
+
+    return Size() - 1;
+}
+
+float TrackIndex::SumLengths() const{
+    // Walk the tree in order, without recursion
+    float sum = 0;
+    vector<int> path;
+    int node = root;
+    while(node != -1  ||  !path.empty()){
+        while(node != -1){
+            path.push_back(node);
+            node = nodes[node].left;
+        }
+
+        node = path.back();
+        path.pop_back();
+        sum += nodes[node].entry.length;
+        node = nodes[node].right;
+    }
+
+    return sum;
+}
+
+
+// HELPERS
+int TrackIndex::CreateNode(const Entry &entry){
+    const Node node = { entry, -1, -1, priorities.Next(), 1, entry.length };
+    if(!free_nodes.empty()){
+        const int index = free_nodes.back();
+        free_nodes.pop_back();
+        nodes[index] = node;
+        return index;
+    }
+
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+void TrackIndex::FreeTree(const int node){
+    if(node == -1)
+        return;
+
+    vector<int> remaining = { node };
+    while(!remaining.empty()){
+        const int cur = remaining.back();
+        remaining.pop_back();
+        if(nodes[cur].left != -1)
+            remaining.push_back(nodes[cur].left);
+        if(nodes[cur].right != -1)
+            remaining.push_back(nodes[cur].right);
+        free_nodes.push_back(cur);
+    }
+}
+
+void TrackIndex::Update(const int node){
+    Node &cur = nodes[node];
+    cur.size = 1 + GetSize(cur.left) + GetSize(cur.right);
+    cur.length = GetLength(cur.left) + cur.entry.length + GetLength(cur.right);
+}
+
+// Splits the subtree into its first count entries, and the rest
+void TrackIndex::Split(const int node, const size_t count, int &left, int &right){
+    if(node == -1){
+        left = -1;
+        right = -1;
+        return;
+    }
+
+    const uint32_t left_size = GetSize(nodes[node].left);
+    if(count <= left_size){
+        Split(nodes[node].left, count, left, nodes[node].left);
+        right = node;
+    }
+    else{
+        Split(nodes[node].right, count - left_size - 1, nodes[node].right, right);
+        left = node;
+    }
+    Update(node);
+}
+
+// Joins two subtrees, where every entry of left comes before every entry of right
+int TrackIndex::Merge(const int left, const int right){
+    if(left == -1)
+        return right;
+    if(right == -1)
+        return left;
+
+    if(nodes[left].priority > nodes[right].priority){
+        nodes[left].right = Merge(nodes[left].right, right);
+        Update(left);
+        return left;
+    }
+    nodes[right].left = Merge(left, nodes[right].left);
+    Update(right);
+    return right;
+}
+
+int TrackIndex::FindNode(size_t index) const{
+    int node = root;
+    while(node != -1){
+        const uint32_t left_size = GetSize(nodes[node].left);
+        if(index == left_size)
+            return node;
+
+        if(index < left_size){
+            node = nodes[node].left;
+        }
+        else{
+            index -= left_size + 1;
+            node = nodes[node].right;
+        }
+    }
+
+    return -1;
+}
+
+uint32_t TrackIndex::GetSize(const int node) const{
+    return (node != -1) ? nodes[node].size : 0;
+}
+
+double TrackIndex::GetLength(const int node) const{
+    return (node != -1) ? nodes[node].length : 0;
+}
@@ -0,0 +1,87 @@
+#ifndef TRACKINDEX_H
+#define TRACKINDEX_H
+
+#include <cstdint>
+#include <vector>
+#include "TreapPriority.h"
+#include "tinyxml2.h"
+
+
+// The entries of a track, in order, kept in a balanced tree that also sums their lengths.
+// Finding an entry by position or by time, inserting, and removing are all O(log n), so entries can be added or removed
+// anywhere on the track, and the entries after them move along with it.
+class TrackIndex{
+    public:
+    enum EntryType{
+        CLIP,
+        BLANK,
+    };
+    struct Entry{
+        EntryType entry_type;
+        float length;
+        float start_offset;
+        tinyxml2::XMLElement* element;      // The entry or blank in the playlist
+    };
+
+    // CONSTRUCTORS
+    TrackIndex();
+
+    // SETTERS
+    /** Adds the entry after every other entry.
+     */
+    void PushBack(const Entry &entry);
+    /** Adds the entry at the given position, so the entry at that position and every one after it move back by one.
+     */
+    void Insert(const size_t index, const Entry &entry);
+    /** Removes the entry at the given position, so every entry after it moves forward by one.
+     */
+    void Erase(const size_t index);
+    /** Replaces the entry at the given position. Entries can't be changed through At(), since their lengths are summed.
+     */
+    void Set(const size_t index, const Entry &entry);
+    /** Removes every entry from the given position onward.
+     */
+    void Truncate(const size_t index);
+
+    // GETTERS
+    size_t Size() const;
+    const Entry& At(const size_t index) const;
+    /** Returns the time the entry at the given position starts at, which is the sum of the lengths of the entries before it.
+     */
+    double GetStartTime(const size_t index) const;
+    /** Returns the position of the entry playing at the given time, or Size() if the time is past the last entry.
+     */
+    size_t FindIndexAt(const double time) const;
+    /** Adds the lengths of every entry one at a time, in order, so the sum is rounded the same as a running total of them would be.
+     */
+    float SumLengths() const;
+
+
+    private:
+    struct Node{
+        Entry entry;
+        int left;
+        int right;
+        uint32_t priority;
+        uint32_t size;      // Number of entries in the subtree
+        double length;      // Sum of the lengths in the subtree
+    };
+
+    int CreateNode(const Entry &entry);
+    void FreeTree(const int node);
+    void Update(const int node);
+    void Split(const int node, const size_t count, int &left, int &right);
+    int Merge(const int left, const int right);
+    int FindNode(size_t index) const;
+    uint32_t GetSize(const int node) const;
+    double GetLength(const int node) const;
+
+    // PRIVATE VARIABLES
+    std::vector<Node> nodes;        // Nodes refer to each other by position in here, so that growing it doesn't invalidate them
+    std::vector<int> free_nodes;
+    int root;
+    TreapPriority priorities;
+};
+
+
+#endif
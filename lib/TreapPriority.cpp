@@ -0,0 +1,17 @@
+#include "TreapPriority.h"
+
+
+// CONSTRUCTORS
+TreapPriority::TreapPriority(){
+    state = 0x9e3779b9;
+}
+
+
+// SETTERS
+uint32_t TreapPriority::Next(){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
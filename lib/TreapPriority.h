@@ -0,0 +1,26 @@
+#ifndef TREAPPRIORITY_H
+#define TREAPPRIORITY_H
+
+#include <cstdint>
+
+
+// Generates the priorities of the nodes of the balanced trees in TrackIndex and TimelineIndex.
+// The priorities come from xorshift32 with a fixed seed, so the shape of a tree is the same on every run.
+class TreapPriority{
+    public:
+    // CONSTRUCTORS
+    TreapPriority();
+
+    // SETTERS
+    /** Returns the priority of the next node.
+     */
+    uint32_t Next();
+
+
+    private:
+    // PRIVATE VARIABLES
+    uint32_t state;
+};
+
+
+#endif